@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+#include <eosiolib/datastream.hpp>
+#include <eosiolib/varint.hpp>
+
+#define ARENA_SIZE (64 * 1024)
+
+//原生编译的多线程工具（tools/mdssim）中每个线程使用独立的arena
+#ifdef EOSIO_NATIVE
+#define ARENA_LOCAL thread_local
+#else
+#define ARENA_LOCAL
+#endif
+
+//单次action内的线性(bump)分配器，apply()开始时重置，只收回最后分配的块；容量不足时退回到全局堆
+class arena {
+  public:
+    static void reset() { offset() = 0; }
+
+    static void* allocate(size_t size) {
+        size = align(size);
+        if(offset() + size <= ARENA_SIZE){
+            void* p = buffer() + offset();
+            offset() += size;
+            return p;
+        }
+        return ::operator new(size);
+    }
+
+    //按后进先出释放的块（如循环内的临时vector）可以重复使用；vector扩容时旧块在新块之前，仍需预先reserve
+    static void deallocate(void* p, size_t size) {
+        if(!contains(p)){
+            ::operator delete(p);
+            return;
+        }
+        size = align(size);
+        if(static_cast<char*>(p) + size == buffer() + offset()){
+            offset() -= size;
+        }
+    }
+
+    static bool contains(const void* p) {
+        auto c = static_cast<const char*>(p);
+        return c >= buffer() && c < buffer() + ARENA_SIZE;
+    }
+
+  private:
+    static size_t align(size_t size) {
+        return (size + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+    }
+
+    static char* buffer() {
+        alignas(max_align_t) static ARENA_LOCAL char buf[ARENA_SIZE];
+        return buf;
+    }
+
+    static size_t& offset() {
+        static ARENA_LOCAL size_t off = 0;
+        return off;
+    }
+};
+
+template<typename T>
+struct arena_allocator {
+    typedef T value_type;
+
+    arena_allocator() = default;
+    template<typename U>
+    arena_allocator(const arena_allocator<U>&) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena::allocate(n * sizeof(T))); }
+    void deallocate(T* p, size_t n) { arena::deallocate(p, n * sizeof(T)); }
+
+    template<typename U>
+    bool operator == (const arena_allocator<U>&) const { return true; }
+    template<typename U>
+    bool operator != (const arena_allocator<U>&) const { return false; }
+};
+
+template<typename T>
+using arena_vector = std::vector<T, arena_allocator<T>>;
+
+//与eosiolib中std::vector的序列化格式一致，表结构及ABI不变
+template<typename DataStream, typename T>
+DataStream& operator << (DataStream& ds, const arena_vector<T>& v) {
+    ds << eosio::unsigned_int(v.size());
+    for(const auto& i : v)
+        ds << i;
+    return ds;
+}
+
+template<typename DataStream, typename T>
+DataStream& operator >> (DataStream& ds, arena_vector<T>& v) {
+    eosio::unsigned_int s;
+    ds >> s;
+    v.resize(s.value);
+    for(auto& i : v)
+        ds >> i;
+    return ds;
+}
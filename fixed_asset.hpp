@@ -0,0 +1,36 @@
+#pragma once
+#include <eosiolib/asset.hpp>
+
+//符号固定的资产字段，只序列化int64金额，符号由类型确定；可与asset互相转换，转换时检查符号
+template<symbol_name Symbol>
+struct fixed_asset {
+    int64_t amount = 0;
+
+    static constexpr symbol_name symbol = Symbol;
+
+    fixed_asset() = default;
+
+    fixed_asset(const eosio::asset& a) {
+        eosio_assert(a.symbol == Symbol, "symbol mismatch");
+        amount = a.amount;
+    }
+
+    operator eosio::asset()const { return eosio::asset(amount, Symbol); }
+
+    fixed_asset& operator += (const eosio::asset& a) {
+        eosio_assert(a.symbol == Symbol, "symbol mismatch");
+        amount += a.amount;
+        return *this;
+    }
+
+    fixed_asset& operator -= (const eosio::asset& a) {
+        eosio_assert(a.symbol == Symbol, "symbol mismatch");
+        amount -= a.amount;
+        return *this;
+    }
+
+    EOSLIB_SERIALIZE(fixed_asset, (amount))
+};
+
+template<symbol_name Symbol>
+constexpr symbol_name fixed_asset<Symbol>::symbol;
@@ -3,14 +3,15 @@
 
 using namespace eosio;
 
-asset medishares::keymarket::convert_to_exchange( connector& c, asset in ) {
+template<typename Connector>
+asset medishares::keymarket::convert_to_exchange( Connector& c, asset in ) {
     real_type R(supply.amount);
     real_type C(c.balance.amount+in.amount);
     real_type F(c.weight/1000.0);
     real_type T(in.amount);
     real_type ONE(1.0);
 
-    real_type E = -R * (ONE - std::pow( ONE + T / C, F) );
+    real_type E = -R * (ONE - real_pow( ONE + T / C, F) );
     int64_t issued = int64_t(E);
 
     supply.amount += issued;
@@ -19,7 +20,8 @@ asset medishares::keymarket::convert_to_exchange( connector& c, asset in ) {
     return asset( issued, supply.symbol );
 }
 
-asset medishares::keymarket::convert_from_exchange( connector& c, asset in ) {
+template<typename Connector>
+asset medishares::keymarket::convert_from_exchange( Connector& c, asset in ) {
     eosio_assert( in.symbol== supply.symbol, "unexpected asset symbol input" );
 
     real_type R(supply.amount - in.amount);
@@ -28,7 +30,7 @@ asset medishares::keymarket::convert_from_exchange( connector& c, asset in ) {
     real_type E(in.amount);
     real_type ONE(1.0);
 
-    real_type T = C * (std::pow( ONE + E/R, F) - ONE);
+    real_type T = C * (real_pow( ONE + E/R, F) - ONE);
     int64_t out = int64_t(T);
 
     supply.amount -= in.amount;
@@ -83,11 +85,8 @@ void medishares::init(uint64_t guarantee_rate, uint64_t ref_rate, asset max_clai
 
     itr = keymarket.emplace(_self, [&](auto& k) {
         k.supply.amount = KEY_INIT_SUPPLY;
-        k.supply.symbol = KEYCORE_SYMBOL;
         k.base.balance.amount = 400000000;
-        k.base.balance.symbol = KEY_SYMBOL;
         k.quote.balance.amount = 20000000000;
-        k.quote.balance.symbol = TOKEN_SYMBOL;
     });
 
     auto glb = global.begin();
@@ -107,12 +106,23 @@ void medishares::init(uint64_t guarantee_rate, uint64_t ref_rate, asset max_clai
         gl.time_for_announcement = time_for_announcement;
         gl.total_key = asset(0, KEY_SYMBOL);
         gl.total_skey = asset(0, STAKE_SYMBOL);
-        gl.tatal_donate = asset(0, TOKEN_SYMBOL);
+        gl.total_donate = asset(0, TOKEN_SYMBOL);
         gl.rule_hash = rule_hash;
+        gl.merkle_root = merkle_zero();
+        gl.shards = ACCOUNT_SHARDS;
     });
 }
 
-void medishares::handleTransfer(const account_name from, const account_name to, const asset& quantity, string memo)
+//从memo中截取[begin, end)之间的账户名，直接在栈上转换，不产生临时string
+static account_name memo_to_name(const string& memo, size_t begin, size_t end){
+    char name_str[13];
+    size_t len = end - begin;
+    memo.copy(name_str, len, begin);
+    name_str[len] = '\0';
+    return string_to_name(name_str);
+}
+
+void medishares::handleTransfer(const account_name from, const account_name to, const asset& quantity, const string& memo)
 {
     if(from == _self || to != _self){
         return;
@@ -126,21 +136,13 @@ void medishares::handleTransfer(const account_name from, const account_name to,
     account_name referrer = 0;
     uint64_t ref_amount = 0;
 
-    memo.erase(memo.begin(), find_if(memo.begin(), memo.end(), [](int ch) {
-        return !isspace(ch);
-    }));
-    memo.erase(find_if(memo.rbegin(), memo.rend(), [](int ch) {
-        return !isspace(ch);
-    }).base(), memo.end());
-
     //memo:"buyfor":"xxxxxxxxxxxx","ref":"xxxxxxxxxxxx"
     auto separator_pos = memo.find("\"buyfor\":\"");
     if (separator_pos != string::npos) {
         auto end_pos =  memo.find("\"", separator_pos+10);
         eosio_assert(end_pos != string::npos, "parse memo error");
         eosio_assert(end_pos - separator_pos <= 22 && end_pos - separator_pos > 10, "invalid account name");
-        string beneficiary_account_str = memo.substr(separator_pos + 10, end_pos - 1);
-        participator = string_to_name(beneficiary_account_str.c_str());
+        participator = memo_to_name(memo, separator_pos + 10, end_pos);
         eosio_assert(is_account(participator), "participator account does not exist");
     }
 
@@ -149,8 +151,7 @@ void medishares::handleTransfer(const account_name from, const account_name to,
         auto end_pos =  memo.find("\"", separator_pos+7);
         eosio_assert(end_pos != string::npos, "parse memo error");
         eosio_assert(end_pos - separator_pos <= 19 && end_pos - separator_pos > 7, "invalid account name");
-        string referral_account_str = memo.substr(separator_pos + 7, end_pos - 1);
-        referrer = string_to_name(referral_account_str.c_str());
+        referrer = memo_to_name(memo, separator_pos + 7, end_pos);
         eosio_assert(is_account(referrer), "referrer account does not exist");
     }
 
@@ -158,7 +159,7 @@ void medishares::handleTransfer(const account_name from, const account_name to,
     eosio_assert(glb != global.end(), "the global table does not exist");
 
     if(referrer != 0){
-        ref_amount = (uint64_t)(quantity.amount * glb->ref_rate / 1000);
+        ref_amount = prorata(quantity.amount, glb->ref_rate, 1000).part;
         eosio_assert(ref_amount > 0, "referral asset too small");
 
         action(
@@ -169,16 +170,19 @@ void medishares::handleTransfer(const account_name from, const account_name to,
     }
 
     uint64_t pool_amount = quantity.amount - ref_amount;
-    uint64_t guarantee_amount = (uint64_t)((double)glb->guarantee_rate /(double)(1000 - glb->ref_rate) * pool_amount);
+    //分割余数计入分红池，两池之和恰好等于pool_amount
+    uint64_t guarantee_amount = prorata(pool_amount, glb->guarantee_rate, 1000 - glb->ref_rate).part;
     uint64_t bonus_amount = pool_amount - guarantee_amount;
     eosio_assert(bonus_amount > 0, "bonus amount abnormity");
 
-    if(!has_balance(participator, asset(guarantee_amount, TOKEN_SYMBOL))){
+    bool new_member = !has_balance(participator, asset(guarantee_amount, TOKEN_SYMBOL));
+    if(new_member){
         global.modify(glb, 0, [&](auto& gl){
             gl.guaranteed_accounts += 1;
         });
     }
     add_balance(participator, asset(guarantee_amount, TOKEN_SYMBOL), _self);
+    update_shardstat(shard_of(participator), new_member ? 1 : 0, guarantee_amount);
 
     auto key_out = asset(0, KEY_SYMBOL);
     const auto& market = keymarket.get(KEYCORE_SYMBOL, "key market does not exist");
@@ -193,6 +197,13 @@ void medishares::handleTransfer(const account_name from, const account_name to,
         gl.bonus_pool = gl.bonus_pool + asset(bonus_amount, TOKEN_SYMBOL);
         gl.total_key = gl.total_key + key_out;
     });
+
+    update_epochstat([&](auto& s){
+        s.deposit += quantity;
+        s.guarantee_in.amount += guarantee_amount;
+        s.new_members += new_member ? 1 : 0;
+        s.key_issued += key_out;
+    });
 }
 
 void medishares::sellkey(account_name account, asset key_quantity){
@@ -209,7 +220,7 @@ void medishares::sellkey(account_name account, asset key_quantity){
     action(
         permission_level{_self, N(active)},
         TOKEN_CONTRACT, N(transfer),
-        std::make_tuple(_self, account, tokens_out, std::string("sell "+std::to_string(key_quantity.amount)+" key"))
+        std::make_tuple(_self, account, tokens_out, std::string("sell key"))
     ).send();
 
     auto glb = global.begin();
@@ -219,8 +230,13 @@ void medishares::sellkey(account_name account, asset key_quantity){
         gl.bonus_pool.amount -= tokens_out.amount;
         gl.total_key.amount -= key_quantity.amount;
     });
+    update_epochstat([&](auto& s){
+        s.key_sold += key_quantity;
+        s.sell_proceeds += tokens_out;
+    });
 
     sub_balance(account, key_quantity);
+    auto& accounts = accounts_of(account);
     auto accounts_itr = accounts.find(account);
     if(accounts_itr->asset_list.size() == 0){
         accounts.erase(accounts_itr);
@@ -244,6 +260,7 @@ void medishares::transfer(account_name from, account_name to, asset quantity, st
     sub_balance(from, quantity);
     add_balance(to, quantity, from);
 
+    auto& accounts = accounts_of(from);
     auto accounts_itr = accounts.find(from);
     if(accounts_itr->asset_list.size() == 0){
         accounts.erase(accounts_itr);
@@ -251,6 +268,7 @@ void medishares::transfer(account_name from, account_name to, asset quantity, st
 }
 
 bool medishares::has_balance(account_name owner, asset currency){
+    auto& accounts = accounts_of(owner);
     auto accounts_itr = accounts.find(owner);
     if(accounts_itr == accounts.end()){
         return false;
@@ -267,6 +285,7 @@ bool medishares::has_balance(account_name owner, asset currency){
 }
 
 void medishares::sub_balance(account_name owner, asset value){
+    auto& accounts = accounts_of(owner);
     auto accounts_itr = accounts.find(owner);
     eosio_assert(accounts_itr != accounts.end(), "account does not exist in this contract");
 
@@ -275,22 +294,28 @@ void medishares::sub_balance(account_name owner, asset value){
     auto list_itr = std::find(accounts_itr->asset_list.begin(), accounts_itr->asset_list.end(), asset_e);
     eosio_assert(list_itr != accounts_itr->asset_list.end(), "account does not have this asset");
     eosio_assert(list_itr->balance.amount >= value.amount, "overdrawn balance");
+    int64_t balance = list_itr->balance.amount - value.amount;
 
-    if(list_itr->balance.amount == value.amount){
+    if(balance == 0){
         accounts.modify(accounts_itr, _self, [&](auto& a){
             a.asset_list.erase(list_itr);
         });
     }else{
-        asset_e.balance.amount = list_itr->balance.amount - value.amount;
+        asset_e.balance.amount = balance;
         accounts.modify(accounts_itr, _self, [&](auto& a){
             a.asset_list.erase(list_itr);
             a.asset_list.push_back(asset_e);
         });
     }
+
+    if(value.symbol == TOKEN_SYMBOL){
+        update_member_leaf(owner, balance);
+    }
 }
 
 void medishares::add_balance(account_name owner, asset value, account_name ram_payer)
 {
+    auto& accounts = accounts_of(owner);
     asset_entry asset_e;
     asset_e.balance = value;
     auto accounts_itr = accounts.find(owner);
@@ -320,6 +345,154 @@ void medishares::add_balance(account_name owner, asset value, account_name ram_p
             });
         }
     }
+
+    if(value.symbol == TOKEN_SYMBOL){
+        update_member_leaf(owner, asset_e.balance.amount);
+    }
+}
+
+static uint64_t merkle_node_id(uint64_t tree, uint64_t level, uint64_t index){
+    return tree << 62 | level << 56 | index;
+}
+
+//互助项目均摊列表的Merkle根，即互助贡献树中该项目叶子的aid_root
+template<typename AidList>
+static checksum256 aid_list_root(const AidList& aid_list){
+    arena_vector<checksum256> aid_hashes;
+    aid_hashes.reserve(aid_list.size());
+    for(const auto& aid : aid_list){
+        aid_hashes.push_back(merkle_leaf(aid.account, aid.aid_quantity.amount));
+    }
+    return merkle_root(aid_hashes);
+}
+
+//将受保余额树中owner的叶子更新为当前保障余额，首次出现的账户使用下一个叶子编号。
+//叶子只记入pending_leaves，结算等一次变动大量余额的操作由update_merkle_root在action结束时一并重算路径，共用的上层节点只写一次
+void medishares::update_member_leaf(account_name owner, int64_t balance){
+    uint64_t index;
+    auto leaf_itr = merkleleaf.find(owner);
+    if(leaf_itr == merkleleaf.end()){
+        auto tree_itr = merkletree.find(MERKLE_BALANCE_TREE);
+        index = tree_itr == merkletree.end() ? 0 : tree_itr->leaves;
+        if(!pending_leaves.empty()){
+            index = std::max(index, pending_leaves.rbegin()->first + 1);
+        }
+        merkleleaf.emplace(_self, [&](auto& l){
+            l.account = owner;
+            l.index = index;
+        });
+    }else{
+        index = leaf_itr->index;
+    }
+    pending_leaves[index] = merkle_leaf(owner, balance);
+}
+
+//已没有保障余额的账户：叶子置为全0哈希并删除merkleleaf行，叶子编号不再复用
+void medishares::remove_member_leaf(account_name owner){
+    auto leaf_itr = merkleleaf.find(owner);
+    if(leaf_itr == merkleleaf.end()) return;
+    pending_leaves[leaf_itr->index] = merkle_zero();
+    merkleleaf.erase(leaf_itr);
+}
+
+//merklenode只存储非0的节点，节点变为全0哈希时删除该行
+void medishares::store_merkle_node(uint64_t tree, uint64_t level, uint64_t index, const checksum256& hash){
+    uint64_t id = merkle_node_id(tree, level, index);
+    auto node_itr = merklenode.find(id);
+    if(merkle_is_zero(hash)){
+        if(node_itr != merklenode.end()){
+            merklenode.erase(node_itr);
+        }
+    }else if(node_itr == merklenode.end()){
+        merklenode.emplace(_self, [&](auto& n){
+            n.id = id;
+            n.hash = hash;
+        });
+    }else{
+        merklenode.modify(node_itr, 0, [&](auto& n){
+            n.hash = hash;
+        });
+    }
+}
+
+void medishares::update_merkle(uint64_t tree, uint64_t index, const checksum256& leaf){
+    std::map<uint64_t, checksum256> nodes;
+    nodes[index] = leaf;
+    update_merkle(tree, nodes);
+}
+
+//更新一组叶子（编号 -> 哈希）并逐层重算到根，每层只读写受影响的节点，多个叶子共用的上层节点只计算和写入一次；
+//nodes在计算中被改写。global.merkle_root在action结束时由update_merkle_root统一更新
+void medishares::update_merkle(uint64_t tree, std::map<uint64_t, checksum256>& nodes){
+    auto tree_itr = merkletree.find(tree);
+    if(tree_itr == merkletree.end()){
+        tree_itr = merkletree.emplace(_self, [&](auto& t){
+            t.tree = tree;
+            t.leaves = 0;
+            t.depth = 0;
+            t.root = merkle_zero();
+        });
+    }
+    uint64_t leaves = std::max(tree_itr->leaves, nodes.rbegin()->first + 1);
+    eosio_assert(leaves <= (1ull << 56), "merkle tree is full");
+    uint64_t depth = merkle_depth(leaves);
+
+    //树高增加时原来的根是新树最左侧路径上的节点。互助贡献树以case_id为叶子编号，树高可能一次增加多层，
+    //中间各层的右侧子树都为空，需先补齐这些左侧节点，路径上的兄弟节点才能取到原来的子树
+    checksum256 spine = tree_itr->root;
+    for(uint64_t level = tree_itr->depth + 1; level < depth && !merkle_is_zero(spine); level ++){
+        spine = merkle_parent(spine, merkle_zero());
+        store_merkle_node(tree, level, 0, spine);
+    }
+
+    for(uint64_t level = 0; ; level ++){
+        for(const auto& node : nodes){
+            store_merkle_node(tree, level, node.first, node.second);
+        }
+        if(level == depth) break;
+
+        //兄弟节点本层也有变动时取新值，否则读表
+        auto node_hash = [&](uint64_t index) -> checksum256 {
+            auto itr = nodes.find(index);
+            if(itr != nodes.end()) return itr->second;
+            auto node_itr = merklenode.find(merkle_node_id(tree, level, index));
+            return node_itr == merklenode.end() ? merkle_zero() : node_itr->hash;
+        };
+        std::map<uint64_t, checksum256> parents;
+        for(const auto& node : nodes){
+            uint64_t parent = node.first >> 1;
+            if(parents.count(parent)) continue;
+            parents[parent] = merkle_parent(node_hash(parent << 1), node_hash(parent << 1 | 1));
+        }
+        nodes.swap(parents);
+    }
+
+    merkletree.modify(tree_itr, 0, [&](auto& t){
+        t.leaves = leaves;
+        t.depth = depth;
+        t.root = nodes.begin()->second;
+    });
+    merkle_dirty = true;
+}
+
+//由apply在action执行完后调用：一次重算本action中变动的受保余额树叶子，global行也只重写一次
+void medishares::update_merkle_root(){
+    if(!pending_leaves.empty()){
+        update_merkle(MERKLE_BALANCE_TREE, pending_leaves);
+        pending_leaves.clear();
+    }
+    if(!merkle_dirty) return;
+    merkle_dirty = false;
+
+    auto balance_itr = merkletree.find(MERKLE_BALANCE_TREE);
+    auto contrib_itr = merkletree.find(MERKLE_CONTRIB_TREE);
+    checksum256 balance_root = balance_itr == merkletree.end() ? merkle_zero() : balance_itr->root;
+    checksum256 contrib_root = contrib_itr == merkletree.end() ? merkle_zero() : contrib_itr->root;
+    auto glb = global.begin();
+    eosio_assert(glb != global.end(), "the global table does not exist");
+    global.modify(glb, 0, [&](auto& gl){
+        gl.merkle_root = merkle_parent(balance_root, contrib_root);
+    });
 }
 
 void medishares::stakekey(account_name account, asset key_quantity){
@@ -337,7 +510,11 @@ void medishares::stakekey(account_name account, asset key_quantity){
         gl.total_key.amount -= key_quantity.amount;
         gl.total_skey.amount += key_quantity.amount;
     });
+    update_epochstat([&](auto& s){
+        s.key_staked.amount += key_quantity.amount;
+    });
 
+    auto& accounts = accounts_of(account);
     auto accounts_itr = accounts.find(account);
 
     //若未投票，直接结束
@@ -383,7 +560,11 @@ void medishares::unstakekey(account_name account, asset key_quantity){
         gl.total_key.amount += key_quantity.amount;
         gl.total_skey.amount -= key_quantity.amount;
     });
+    update_epochstat([&](auto& s){
+        s.key_unstaked += key_quantity;
+    });
 
+    auto& accounts = accounts_of(account);
     auto accounts_itr = accounts.find(account);
 
     //若未投票，直接结束
@@ -424,6 +605,15 @@ bool my_memcmp( void *s1, void *s2, uint32_t n ){
     return true;
 }
 
+//在archdigest中按摘要前8字节顺序查找，找到相同摘要时返回true，否则free_key为可登记的空闲位置
+bool medishares::find_archived_digest(const checksum256& digest, uint64_t& free_key){
+    memcpy(&free_key, digest.hash, sizeof(free_key));
+    for(auto itr = archdigest.find(free_key); itr != archdigest.end(); itr = archdigest.find(++ free_key)){
+        if(memcmp(itr->case_digest.hash, digest.hash, sizeof(digest.hash)) == 0) return true;
+    }
+    return false;
+}
+
 void medishares::propose(account_name proposer, checksum256 case_digest, asset required_fund){
     require_auth(proposer);
     eosio_assert(required_fund.amount > 0, "required_fund cannot be negative");
@@ -438,6 +628,7 @@ void medishares::propose(account_name proposer, checksum256 case_digest, asset r
         gl.cases_num += 1;
     });
 
+    auto& accounts = accounts_of(proposer);
     const auto& accounts_itr = accounts.get(proposer, "the user does not exist");
     eosio_assert(has_balance(proposer, asset(0, TOKEN_SYMBOL)), "the user do not have guarantee balance");
     eosio_assert(accounts_itr.join_time + glb->time_for_observation <= now(), "can not propose in observation period");
@@ -448,6 +639,8 @@ void medishares::propose(account_name proposer, checksum256 case_digest, asset r
         cas_d = cas->case_digest;
         eosio_assert(!my_memcmp(&cas_d, &case_digest, sizeof(checksum256)), "the case already exist");
     }
+    uint64_t free_key;
+    eosio_assert(!find_archived_digest(case_digest, free_key), "the case already exist");
 
     cases.emplace(proposer, [&](auto& c) {
         c.case_id = glb->cases_num;
@@ -464,6 +657,11 @@ void medishares::propose(account_name proposer, checksum256 case_digest, asset r
     accounts.modify(accounts_itr, proposer, [&](auto& a){
         a.latest_apply_time = now();
     });
+
+    update_epochstat([&](auto& s){
+        s.proposals += 1;
+        s.required_fund += required_fund;
+    });
 }
 
 void medishares::approve(account_name account, uint64_t case_id){
@@ -476,6 +674,7 @@ void medishares::approve(account_name account, uint64_t case_id){
     eosio_assert(has_balance(account, asset(0, STAKE_SYMBOL)), "no stake balance object found");
     asset_entry asset_e;
     asset_e.balance = asset(0, STAKE_SYMBOL);
+    auto& accounts = accounts_of(account);
     auto accounts_itr = accounts.find(account);
     auto asset_list_itr = std::find(accounts_itr->asset_list.begin(), accounts_itr->asset_list.end(), asset_e);
 
@@ -501,6 +700,11 @@ void medishares::approve(account_name account, uint64_t case_id){
             c.vote_yes += asset_list_itr->balance;
         });
     }
+
+    update_epochstat([&](auto& s){
+        s.votes += 1;
+        s.vote_skey += asset_list_itr->balance;
+    });
 }
 
 void medishares::unapprove(account_name account, uint64_t case_id){
@@ -513,6 +717,7 @@ void medishares::unapprove(account_name account, uint64_t case_id){
     eosio_assert(has_balance(account, asset(0, STAKE_SYMBOL)), "no stake balance object found");
     asset_entry asset_e;
     asset_e.balance = asset(0, STAKE_SYMBOL);
+    auto& accounts = accounts_of(account);
     auto accounts_itr = accounts.find(account);
     auto asset_list_itr = std::find(accounts_itr->asset_list.begin(), accounts_itr->asset_list.end(), asset_e);
 
@@ -538,6 +743,11 @@ void medishares::unapprove(account_name account, uint64_t case_id){
             c.vote_no += asset_list_itr->balance;
         });
     }
+
+    update_epochstat([&](auto& s){
+        s.votes += 1;
+        s.vote_skey += asset_list_itr->balance;
+    });
 }
 
 void medishares::cancelvote(account_name account, uint64_t case_id){
@@ -550,6 +760,7 @@ void medishares::cancelvote(account_name account, uint64_t case_id){
     eosio_assert(has_balance(account, asset(0, STAKE_SYMBOL)), "no stake balance object found");
     asset_entry asset_e;
     asset_e.balance = asset(0, STAKE_SYMBOL);
+    auto& accounts = accounts_of(account);
     auto accounts_itr = accounts.find(account);
     auto asset_list_itr = std::find(accounts_itr->asset_list.begin(), accounts_itr->asset_list.end(), asset_e);
 
@@ -571,41 +782,11 @@ void medishares::cancelvote(account_name account, uint64_t case_id){
     accounts.modify(accounts_itr, account, [&](auto& a){
         a.vote_list.erase(vote_list_itr);
     });
-}
 
-string uint64_string(uint64_t input, int p)
-{
-    string result;
-    char c;
-    int q=p;
-    uint8_t base = 10;
-    do
-    {
-        if(q!=0)
-        {
-            c = input % base;
-            input /= base;
-            if (c < 10)
-                c += '0';
-            else
-                c += 'A' - 10;
-        }
-        else
-            c = '.';
-        result = c + result;
-        q--;
-    } while (input);
-
-    if(q >= 0)
-    {
-        while(q > 0)
-        {
-            result = '0' + result;
-            q--;
-        }
-        result = "0." + result;
-    }
-    return result;
+    update_epochstat([&](auto& s){
+        s.cancelled_votes += 1;
+        s.cancelled_skey += asset_list_itr->balance;
+    });
 }
 
 void medishares::execproposal(account_name account, uint64_t case_id){
@@ -613,40 +794,94 @@ void medishares::execproposal(account_name account, uint64_t case_id){
     auto case_itr = cases.find(case_id);
     eosio_assert(case_itr != cases.end(), "case does not exist");
     eosio_assert(case_itr->exec_time == 0, "the case completed");
+    eosio_assert(settlements.find(case_id) == settlements.end(), "the case is being settled");
     auto glb = global.begin();
     eosio_assert(glb != global.end(), "the global table does not exist");
     eosio_assert(case_itr->start_time + glb->time_for_vote < now(), "voting has not been completed");
     eosio_assert(glb->guarantee_pool.amount > 0, "guarantee pool empty");
-    const auto& market = keymarket.get(KEYCORE_SYMBOL, "key market does not exist");
+    eosio_assert(keymarket.find(KEYCORE_SYMBOL) != keymarket.end(), "key market does not exist");
     eosio_assert(case_itr->vote_yes.amount > case_itr->vote_no.amount, "insufficient proportion of yes");
 
     eosio_assert((glb->total_key.amount + glb->total_skey.amount) >= (case_itr->vote_yes.amount + case_itr->vote_no.amount), "prevent speculation through KEY manipulation");
-    auto vote_amount = (uint64_t)((double)case_itr->vote_yes.amount/(double)(glb->total_key.amount + glb->total_skey.amount)*case_itr->required_fund.amount);
+    auto vote_amount = prorata(case_itr->required_fund.amount, case_itr->vote_yes.amount, glb->total_key.amount + glb->total_skey.amount).part;
     uint64_t user_num = glb->guaranteed_accounts;
-    auto single_amount = (uint64_t)((double)vote_amount / (double)user_num);
-    eosio_assert(single_amount >= 1, "too little to transfer");
+    auto share = split_even(vote_amount, user_num);
+    eosio_assert(share.part >= 1, "too little to transfer");
+
+    //均摊金额在此确定，各分片按相同的金额扣划；余数由先结算到的受保用户各多承担1个最小单位
+    settlements.emplace(account, [&](auto& s){
+        s.case_id = case_id;
+        s.vote_funding = asset(vote_amount, TOKEN_SYMBOL);
+        s.user_num = user_num;
+        s.single_amount = asset(share.part, TOKEN_SYMBOL);
+        s.remainder = share.remainder;
+        s.settled_shards = 0;
+        s.transfer_fund = asset(0, TOKEN_SYMBOL);
+        s.start_time = now();
+    });
 
+    //未分片时直接完成结算，否则由settleshard对各分片分别结算
+    if(ACCOUNT_SHARDS == 1){
+        settle_shard(account, case_id, 0);
+    }
+}
+
+void medishares::settleshard(account_name account, uint64_t case_id, uint64_t shard){
+    require_auth(account);
+    eosio_assert(shard < ACCOUNT_SHARDS, "invalid shard");
+    settle_shard(account, case_id, shard);
+}
+
+void medishares::settle_shard(account_name account, uint64_t case_id, uint64_t shard){
+    auto stl_itr = settlements.find(case_id);
+    eosio_assert(stl_itr != settlements.end(), "the case is not being settled");
+    eosio_assert((stl_itr->settled_shards & (1ull << shard)) == 0, "the shard already settled");
+    auto case_itr = cases.find(case_id);
+    eosio_assert(case_itr != cases.end(), "case does not exist");
+    auto glb = global.begin();
+    eosio_assert(glb != global.end(), "the global table does not exist");
+
+    auto& accounts = account_shards[shard];
+    uint64_t remainder = stl_itr->remainder;
     asset_entry asset_e;
-    asset_e.balance = asset(single_amount, TOKEN_SYMBOL);
     aid_entry aid_e;
+    //均摊记录先收集在本地，结束时一次写入项目；按分片受保人数预留，避免逐个追加时在arena中反复扩容
+    arena_vector<aid_entry> aid_list;
+    auto stat_itr = shardstat.find(shard);
+    if(stat_itr != shardstat.end()){
+        aid_list.reserve(stat_itr->guaranteed_accounts);
+    }
     uint64_t transfer_amount = 0;
+    int64_t exhausted_accounts = 0;
     for(auto accounts_itr = accounts.begin(); accounts_itr != accounts.end(); ){
-        if(accounts_itr->join_time > 0){
+        //user_num在execproposal时确定，之后才加入受保的用户不计入均摊；与execproposal同一秒加入的用户无法区分先后，一律不扣划
+        if(accounts_itr->join_time > 0 && accounts_itr->join_time < stl_itr->start_time){
+            asset_e.balance = stl_itr->single_amount;
+            if(remainder > 0){
+                asset_e.balance.amount += 1;
+                remainder --;
+            }
             aid_e.account = accounts_itr->account;
             auto asset_list_itr = std::find(accounts_itr->asset_list.begin(), accounts_itr->asset_list.end(), asset_e);
             if(asset_list_itr->balance.amount > asset_e.balance.amount){
                 transfer_amount += asset_e.balance.amount;
                 sub_balance(accounts_itr->account, asset_e.balance);
                 aid_e.aid_quantity = asset_e.balance;
+                aid_list.push_back(aid_e);
             }else{
-                transfer_amount += asset_list_itr->balance.amount;
-                sub_balance(accounts_itr->account, asset_list_itr->balance);
-                aid_e.aid_quantity = asset_list_itr->balance;
+                //sub_balance会删除该资产项，asset_list_itr随后指向其他资产，先复制余额
+                asset balance = asset_list_itr->balance;
+                transfer_amount += balance.amount;
+                sub_balance(accounts_itr->account, balance);
+                aid_e.aid_quantity = balance;
+                aid_list.push_back(aid_e);
+                exhausted_accounts ++;
+                remove_member_leaf(accounts_itr->account);
                 global.modify(glb, 0, [&](auto& gl){
                     gl.guaranteed_accounts -= 1;
                 });
                 if(accounts_itr->asset_list.size() == 0){
-                    accounts.erase(accounts_itr);
+                    accounts_itr = accounts.erase(accounts_itr);
                     continue;
                 }else{
                     accounts.modify(accounts_itr, account, [&](auto& a){
@@ -654,47 +889,100 @@ void medishares::execproposal(account_name account, uint64_t case_id){
                     });
                 }
             }
-            cases.modify(case_itr, account, [&](auto& c){
-                c.aid_list.push_back(aid_e);
-            });
         }
         accounts_itr ++;
     }
-    eosio_assert(transfer_amount <= glb->guarantee_pool.amount, "internal error");
-
-    string memo = "case_id:";
-    memo.append(std::to_string(case_itr->case_id));
-    memo.append(", vote_yes:");
-    memo.append(std::to_string(case_itr->vote_yes.amount));
-    memo.append("SKEY, vote_no:");
-    memo.append(std::to_string(case_itr->vote_no.amount));
-    memo.append("SKEY, KEY supply:");
-    memo.append(std::to_string(glb->total_key.amount + glb->total_skey.amount));
-    memo.append("KEY, vote funding:");
-    memo.append(uint64_string(vote_amount, 4));
-    memo.append("EMDS, interdependent user:");
-    memo.append(std::to_string(user_num));
-    memo.append(", each contribute:");
-    memo.append(uint64_string(single_amount, 4));
-    memo.append("EMDS, actual funding:");
-    memo.append(uint64_string(transfer_amount, 4));
-    memo.append("EMDS");
+    if(!aid_list.empty()){
+        cases.modify(case_itr, account, [&](auto& c){
+            c.aid_list.reserve(c.aid_list.size() + aid_list.size());
+            c.aid_list.insert(c.aid_list.end(), aid_list.begin(), aid_list.end());
+        });
+    }
+    update_shardstat(shard, -exhausted_accounts, -(int64_t)transfer_amount);
+    if(exhausted_accounts > 0){
+        update_epochstat([&](auto& s){
+            s.exited_members += exhausted_accounts;
+        });
+    }
+
+    settlements.modify(stl_itr, account, [&](auto& s){
+        s.remainder = remainder;
+        s.settled_shards |= (1ull << shard);
+        s.transfer_fund.amount += transfer_amount;
+    });
+
+    uint64_t all_shards = ACCOUNT_SHARDS == 64 ? ~0ull : ((1ull << ACCOUNT_SHARDS) - 1);
+    if(stl_itr->settled_shards != all_shards){
+        return;
+    }
+
+    //所有分片结算完成后统一划款
+    transfer_amount = stl_itr->transfer_fund.amount;
+    eosio_assert(transfer_amount <= (uint64_t)glb->guarantee_pool.amount, "internal error");
+
+    action(
+        permission_level{_self, N(active)},
+        _self, N(receipt),
+        std::make_tuple(case_itr->case_id, asset(case_itr->vote_yes), asset(case_itr->vote_no), glb->total_key + asset(glb->total_skey.amount, KEY_SYMBOL),
+                        stl_itr->vote_funding, stl_itr->user_num, stl_itr->single_amount, stl_itr->transfer_fund)
+    ).send();
+
     action(
         permission_level{_self, N(active)},
         TOKEN_CONTRACT, N(transfer),
-        std::make_tuple(_self, case_itr->proposer, asset(transfer_amount, TOKEN_SYMBOL), memo)
+        std::make_tuple(_self, case_itr->proposer, stl_itr->transfer_fund, std::string("mutual aid"))
     ).send();
 
     global.modify(glb, 0, [&](auto& gl){
         gl.guarantee_pool.amount -= transfer_amount;
         gl.applied_cases += 1;
-        gl.tatal_donate.amount += transfer_amount;
+        gl.total_donate.amount += transfer_amount;
     });
 
     cases.modify(case_itr, account, [&]( auto& c){
         c.exec_time = now();
         c.transfer_fund = asset(transfer_amount, TOKEN_SYMBOL);
     });
+
+    update_merkle(MERKLE_CONTRIB_TREE, case_id, merkle_case_leaf(case_id, aid_list_root(case_itr->aid_list)));
+
+    update_epochstat([&](auto& s){
+        s.paid_cases += 1;
+        s.payouts.amount += transfer_amount;
+    });
+
+    settlements.erase(stl_itr);
+}
+
+void medishares::update_shardstat(uint64_t shard, int64_t accounts_delta, int64_t pool_delta){
+    auto stat_itr = shardstat.find(shard);
+    if(stat_itr == shardstat.end()){
+        shardstat.emplace(_self, [&](auto& s){
+            s.shard = shard;
+            s.guaranteed_accounts = accounts_delta;
+            s.guarantee_pool = asset(pool_delta, TOKEN_SYMBOL);
+        });
+    }else{
+        shardstat.modify(stat_itr, 0, [&](auto& s){
+            s.guaranteed_accounts += accounts_delta;
+            s.guarantee_pool.amount += pool_delta;
+        });
+    }
+}
+
+//按now()所在的统计周期累加统计数据，每次只读写一行
+template<typename Lambda>
+void medishares::update_epochstat(Lambda&& updater){
+    uint64_t epoch = now() / STAT_EPOCH;
+    auto stat_itr = epochstat.find(epoch);
+    if(stat_itr == epochstat.end()){
+        epochstat.emplace(_self, [&](auto& s){
+            s.epoch = epoch;
+            updater(s);
+        });
+    }else{
+        epochstat.modify(stat_itr, 0, updater);
+    }
 }
 
 void medishares::delproposal(account_name account, uint64_t case_id){
@@ -706,12 +994,15 @@ void medishares::delproposal(account_name account, uint64_t case_id){
     eosio_assert(glb != global.end(), "the global table does not exist");
 
     if(case_itr->exec_time == 0){
+        eosio_assert(settlements.find(case_id) == settlements.end(), "can not delete during settlement");
         if(case_itr->proposer != account){
             eosio_assert(case_itr->start_time + glb->time_for_vote < now(), "voting has not been completed");
             eosio_assert(case_itr->vote_yes.amount <= case_itr->vote_no.amount, "passed cases can not be deleted by others");
         }
     }else{
-        eosio_assert(case_itr->exec_time + glb->time_for_announcement >= now(), "can not delete during announcemention");
+        //已划款的项目不直接删除，公示期过后转为归档记录
+        archive(case_id);
+        return;
     }
 
     cases.erase(case_itr);
@@ -728,3 +1019,340 @@ void medishares::updaterule(string rule_hash){
         gl.rule_hash = rule_hash;
     });
 }
+
+//将旧版本keymarket、global、cases表中的数据转存为只存储金额的新表，每次最多迁移max_rows个项目
+void medishares::migrate(uint64_t max_rows){
+    require_auth(_self);
+    eosio_assert(max_rows > 0, "max_rows must be positive");
+
+    eosio::multi_index<N(keymarket), legacy_keymarket> legacy_markets(_self, _self);
+    auto market_itr = legacy_markets.find(KEYCORE_SYMBOL);
+    if(market_itr != legacy_markets.end()){
+        eosio_assert(keymarket.find(KEYCORE_SYMBOL) == keymarket.end(), "key market already migrated");
+        eosio_assert(market_itr->base.weight == keymarket::connector<KEY_SYMBOL>::weight &&
+                     market_itr->quote.weight == keymarket::connector<TOKEN_SYMBOL>::weight, "unexpected connector weight");
+        keymarket.emplace(_self, [&](auto& k){
+            k.supply = market_itr->supply;
+            k.base.balance = market_itr->base.balance;
+            k.quote.balance = market_itr->quote.balance;
+        });
+        legacy_markets.erase(market_itr);
+    }
+
+    eosio::multi_index<N(global), legacy_global> legacy_globals(_self, _self);
+    auto legacy_glb = legacy_globals.begin();
+    if(legacy_glb != legacy_globals.end()){
+        eosio_assert(global.begin() == global.end(), "global table already migrated");
+        global.emplace(_self, [&](auto& gl){
+            gl.ref_rate = legacy_glb->ref_rate;
+            gl.guarantee_rate = legacy_glb->guarantee_rate;
+            gl.guarantee_pool = legacy_glb->guarantee_pool;
+            gl.bonus_pool = legacy_glb->bonus_pool;
+            gl.cases_num = legacy_glb->cases_num;
+            gl.applied_cases = legacy_glb->applied_cases;
+            gl.guaranteed_accounts = legacy_glb->guaranteed_accounts;
+            gl.max_claim = legacy_glb->max_claim;
+            gl.min_apply_interval = legacy_glb->min_apply_interval;
+            gl.time_for_vote = legacy_glb->time_for_vote;
+            gl.time_for_observation = legacy_glb->time_for_observation;
+            gl.time_for_announcement = legacy_glb->time_for_announcement;
+            gl.total_key = legacy_glb->total_key;
+            gl.total_skey = legacy_glb->total_skey;
+            gl.total_donate = legacy_glb->tatal_donate;
+            gl.rule_hash = legacy_glb->rule_hash;
+            gl.merkle_root = merkle_zero();
+            //旧版本没有shardstat，须执行reshard统计后才能使用
+            gl.shards = 0;
+        });
+        legacy_globals.erase(legacy_glb);
+    }
+
+    //新表的RAM由合约账户支付
+    eosio::multi_index<N(cases), legacy_cases> legacy_case_table(_self, _self);
+    auto case_itr = legacy_case_table.begin();
+    for(uint64_t rows = 0; rows < max_rows && case_itr != legacy_case_table.end(); rows ++){
+        eosio_assert(cases.find(case_itr->case_id) == cases.end(), "case already migrated");
+        cases.emplace(_self, [&](auto& c){
+            c.case_id = case_itr->case_id;
+            c.case_digest = case_itr->case_digest;
+            c.proposer = case_itr->proposer;
+            c.required_fund = case_itr->required_fund;
+            c.start_time = case_itr->start_time;
+            c.exec_time = case_itr->exec_time;
+            c.vote_yes = case_itr->vote_yes;
+            c.vote_no = case_itr->vote_no;
+            c.transfer_fund = case_itr->transfer_fund;
+            c.aid_list.reserve(case_itr->aid_list.size());
+            for(const auto& aid : case_itr->aid_list){
+                c.aid_list.push_back(aid_entry{aid.account, aid.aid_quantity});
+            }
+        });
+        case_itr = legacy_case_table.erase(case_itr);
+    }
+}
+
+//accounts表的分片数与ACCOUNT_SHARDS不一致时，按账户名定位的scope及shardstat都不可靠，除init、migrate、reshard、updaterule外的操作均不能执行
+void medishares::check_shards(){
+    auto glb = global.begin();
+    if(glb != global.end()){
+        eosio_assert(glb->shards == ACCOUNT_SHARDS, "accounts are not sharded as ACCOUNT_SHARDS, execute reshard first");
+    }
+}
+
+//按当前的ACCOUNT_SHARDS重新分布accounts表并重建shardstat：遍历全部MAX_ACCOUNT_SHARDS个scope，不在所属分片的行移到所属分片，
+//并按分片统计受保用户数及保障余额。每次最多处理max_rows行，进度保存在reshardstat表中；遍历开始时清空shardstat，完成前其他操作均不能执行
+void medishares::reshard(uint64_t max_rows){
+    require_auth(_self);
+    eosio_assert(max_rows > 0, "max_rows must be positive");
+    eosio_assert(settlements.begin() == settlements.end(), "can not reshard during settlement");
+    auto glb = global.begin();
+    eosio_assert(glb != global.end(), "the global table does not exist");
+
+    auto rs_itr = reshardstat.find(0);
+    if(rs_itr == reshardstat.end()){
+        eosio_assert(glb->shards != ACCOUNT_SHARDS, "accounts already sharded as ACCOUNT_SHARDS");
+        for(auto stat_itr = shardstat.begin(); stat_itr != shardstat.end(); ){
+            stat_itr = shardstat.erase(stat_itr);
+        }
+        for(uint64_t shard = 0; shard < ACCOUNT_SHARDS; shard ++){
+            update_shardstat(shard, 0, 0);
+        }
+        global.modify(glb, 0, [&](auto& gl){
+            gl.shards = 0;
+        });
+        rs_itr = reshardstat.emplace(_self, [&](auto& r){
+            r.id = 0;
+        });
+    }
+
+    uint64_t scope = rs_itr->scope;
+    account_name cursor = rs_itr->cursor;
+    uint64_t moved_rows = 0;
+    account_name waiting_payer = 0;
+    int64_t guaranteed[ACCOUNT_SHARDS] = {0};
+    int64_t pool[ACCOUNT_SHARDS] = {0};
+    asset_entry token_e;
+    token_e.balance = asset(0, TOKEN_SYMBOL);
+    for(uint64_t rows = 0; rows < max_rows && scope < MAX_ACCOUNT_SHARDS; ){
+        accounts_index extra_scope(_self, _self + scope);
+        auto& accounts = scope < ACCOUNT_SHARDS ? account_shards[scope] : extra_scope;
+        auto accounts_itr = accounts.lower_bound(cursor);
+        if(accounts_itr == accounts.end()){
+            scope ++;
+            cursor = 0;
+            continue;
+        }
+        //移动的行沿用原付费账户，链上向其他账户计费RAM须有其授权，未授权时停在该行
+        uint64_t home = shard_of(accounts_itr->account);
+        account_name payer = accounts_itr->ram_payer == 0 ? _self : accounts_itr->ram_payer;
+        if(home != scope && payer != _self && !has_auth(payer)){
+            waiting_payer = payer;
+            break;
+        }
+        rows ++;
+        cursor = accounts_itr->account + 1;
+
+        //所属分片在当前scope之后的行，移过去后在遍历到该分片时统计
+        if(home <= scope){
+            if(accounts_itr->join_time > 0){
+                guaranteed[home] ++;
+            }
+            auto token_itr = std::find(accounts_itr->asset_list.begin(), accounts_itr->asset_list.end(), token_e);
+            if(token_itr != accounts_itr->asset_list.end()){
+                pool[home] += token_itr->balance.amount;
+            }
+        }
+        if(home != scope){
+            account_shards[home].emplace(payer, [&](auto& a){
+                a = *accounts_itr;
+            });
+            accounts.erase(accounts_itr);
+            moved_rows ++;
+        }
+    }
+
+    for(uint64_t shard = 0; shard < ACCOUNT_SHARDS; shard ++){
+        if(guaranteed[shard] != 0 || pool[shard] != 0){
+            update_shardstat(shard, guaranteed[shard], pool[shard]);
+        }
+    }
+
+    if(scope < MAX_ACCOUNT_SHARDS){
+        reshardstat.modify(rs_itr, 0, [&](auto& r){
+            r.scope = scope;
+            r.cursor = cursor;
+            r.moved_rows += moved_rows;
+            r.waiting_payer = waiting_payer;
+        });
+        return;
+    }
+
+    //遍历完成：gc的位置可能指向已不存在的分片，从头开始
+    reshardstat.erase(rs_itr);
+    global.modify(glb, 0, [&](auto& gl){
+        gl.shards = ACCOUNT_SHARDS;
+    });
+    auto gc_itr = gcstate.find(0);
+    if(gc_itr != gcstate.end()){
+        gcstate.modify(gc_itr, 0, [&](auto& g){
+            g.shard = 0;
+            g.cursor = 0;
+        });
+    }
+}
+
+//回收accounts表中的无效数据：删除金额为0的资产项，以及项目已删除或投票期已过、不再起作用的投票项，资产列表为空的行整行删除。
+//金额为0的保障余额视同用尽，该用户退出受保。每次最多检查max_rows行，遍历位置保存在gcstate表中，任何账户都可以执行
+void medishares::gc(uint64_t max_rows){
+    eosio_assert(max_rows > 0, "max_rows must be positive");
+    eosio_assert(settlements.begin() == settlements.end(), "can not collect during settlement");
+    auto glb = global.begin();
+    eosio_assert(glb != global.end(), "the global table does not exist");
+
+    auto gc_itr = gcstate.find(0);
+    if(gc_itr == gcstate.end()){
+        gc_itr = gcstate.emplace(_self, [&](auto& g){
+            g.id = 0;
+        });
+    }
+
+    uint64_t shard = gc_itr->shard;
+    account_name cursor = gc_itr->cursor;
+    uint64_t rounds = 0;
+    uint64_t erased_rows = 0;
+    uint64_t compacted_rows = 0;
+    uint64_t reclaimed = 0;
+    uint64_t shard_ends = 0;
+    uint64_t exited_members = 0;
+    for(uint64_t rows = 0; rows < max_rows; ){
+        auto& accounts = account_shards[shard];
+        auto accounts_itr = accounts.lower_bound(cursor);
+        if(accounts_itr == accounts.end()){
+            shard = (shard + 1) % ACCOUNT_SHARDS;
+            cursor = 0;
+            if(shard == 0) rounds ++;
+            //分片末尾不计入max_rows；每次最多绕回一圈，避免在小表上重复遍历同样的行
+            if(++ shard_ends == ACCOUNT_SHARDS) break;
+            continue;
+        }
+        rows ++;
+        cursor = accounts_itr->account + 1;
+
+        //受保余额树上线前加入的用户，在gc遍历到时补登叶子；已没有保障余额的账户（余额用尽或整行删除）删除叶子，不再占用合约的RAM
+        asset_entry token_e;
+        token_e.balance = asset(0, TOKEN_SYMBOL);
+        auto token_itr = std::find(accounts_itr->asset_list.begin(), accounts_itr->asset_list.end(), token_e);
+        bool guaranteed = token_itr != accounts_itr->asset_list.end() && token_itr->balance.amount != 0;
+        if(merkleleaf.find(accounts_itr->account) == merkleleaf.end()){
+            if(guaranteed){
+                update_member_leaf(accounts_itr->account, token_itr->balance.amount);
+            }
+        }else if(!guaranteed){
+            remove_member_leaf(accounts_itr->account);
+        }
+
+        bool exhausted = false;
+        arena_vector<asset_entry> asset_list;
+        for(const auto& asset_e : accounts_itr->asset_list){
+            if(asset_e.balance.amount != 0){
+                asset_list.push_back(asset_e);
+            }else if(asset_e.balance.symbol == TOKEN_SYMBOL && accounts_itr->join_time > 0){
+                exhausted = true;
+            }
+        }
+        arena_vector<vote_entry> vote_list;
+        for(const auto& vote_e : accounts_itr->vote_list){
+            auto case_itr = cases.find(vote_e.case_id);
+            if(case_itr != cases.end() && case_itr->start_time + glb->time_for_vote >= now()){
+                vote_list.push_back(vote_e);
+            }
+        }
+        if(asset_list.size() == accounts_itr->asset_list.size() && vote_list.size() == accounts_itr->vote_list.size()){
+            continue;
+        }
+
+        if(exhausted){
+            global.modify(glb, 0, [&](auto& gl){
+                gl.guaranteed_accounts -= 1;
+            });
+            update_shardstat(shard, -1, 0);
+            exited_members ++;
+        }
+
+        uint64_t row_size = pack_size(*accounts_itr);
+        if(asset_list.size() == 0){
+            accounts.erase(accounts_itr);
+            erased_rows ++;
+            reclaimed += row_size + ROW_OVERHEAD;
+        }else{
+            accounts.modify(accounts_itr, 0, [&](auto& a){
+                a.asset_list = std::move(asset_list);
+                a.vote_list = std::move(vote_list);
+                if(exhausted){
+                    a.join_time = 0;
+                }
+            });
+            compacted_rows ++;
+            reclaimed += row_size - pack_size(*accounts_itr);
+        }
+    }
+
+    gcstate.modify(gc_itr, 0, [&](auto& g){
+        g.shard = shard;
+        g.cursor = cursor;
+        g.rounds += rounds;
+        g.erased_rows += erased_rows;
+        g.compacted_rows += compacted_rows;
+        g.reclaimed_bytes += reclaimed;
+        g.last_reclaimed = reclaimed;
+    });
+    if(exited_members > 0){
+        update_epochstat([&](auto& s){
+            s.exited_members += exited_members;
+        });
+    }
+}
+
+//公示期结束的已划款项目压缩为定长的归档行，并删除带均摊列表的完整记录；任何账户都可以执行
+void medishares::archive(uint64_t case_id){
+    auto glb = global.begin();
+    eosio_assert(glb != global.end(), "the global table does not exist");
+    auto case_itr = cases.find(case_id);
+    eosio_assert(case_itr != cases.end(), "case does not exist");
+    eosio_assert(case_itr->exec_time != 0, "case has not been executed");
+    eosio_assert(case_itr->exec_time + glb->time_for_announcement < now(), "can not archive during announcemention");
+
+    checksum256 aid_root = aid_list_root(case_itr->aid_list);
+    //互助贡献树上线前结算的项目没有叶子，归档时补登
+    if(merklenode.find(merkle_node_id(MERKLE_CONTRIB_TREE, 0, case_id)) == merklenode.end()){
+        update_merkle(MERKLE_CONTRIB_TREE, case_id, merkle_case_leaf(case_id, aid_root));
+    }
+
+    casearchive.emplace(_self, [&](auto& a){
+        a.case_id = case_itr->case_id;
+        a.case_digest = case_itr->case_digest;
+        a.proposer = case_itr->proposer;
+        a.required_fund = case_itr->required_fund;
+        a.start_time = case_itr->start_time;
+        a.exec_time = case_itr->exec_time;
+        a.vote_yes = case_itr->vote_yes;
+        a.vote_no = case_itr->vote_no;
+        a.transfer_fund = case_itr->transfer_fund;
+        a.contributors = case_itr->aid_list.size();
+        a.aid_root = aid_root;
+    });
+    uint64_t free_key;
+    if(!find_archived_digest(case_itr->case_digest, free_key)){
+        archdigest.emplace(_self, [&](auto& d){
+            d.digest_key = free_key;
+            d.case_digest = case_itr->case_digest;
+            d.case_id = case_itr->case_id;
+        });
+    }
+    cases.erase(case_itr);
+}
+
+//互助划款回执，仅用于在链上记录execproposal的结算数据，不修改任何状态
+void medishares::receipt(uint64_t case_id, asset vote_yes, asset vote_no, asset key_supply, asset vote_funding, uint64_t user_num, asset single_amount, asset transfer_fund){
+    require_auth(_self);
+}
@@ -1,9 +1,15 @@
 #include <functional>
+#include <deque>
+#include <map>
 #include <string>
-#include <cmath>
 #include <eosiolib/eosio.hpp>
 #include <eosiolib/transaction.hpp>
 #include <eosiolib/asset.hpp>
+#include "arena.hpp"
+#include "split.hpp"
+#include "fixed_asset.hpp"
+#include "real_math.hpp"
+#include "merkle.hpp"
 
 #define KEY_SYMBOL S(0,KEY)
 #define STAKE_SYMBOL S(0,SKEY)
@@ -14,11 +20,33 @@
 
 #define KEY_INIT_SUPPLY 100000000000000
 
+//accounts表按账户名分片存放的scope数量，分片0使用_self作为scope；结算时用uint64位图记录已完成的分片。
+//修改后须执行reshard把已有的行移到新的分片
+#define ACCOUNT_SHARDS 1
+#define MAX_ACCOUNT_SHARDS 64
+static_assert(ACCOUNT_SHARDS >= 1 && ACCOUNT_SHARDS <= MAX_ACCOUNT_SHARDS, "ACCOUNT_SHARDS must be in [1, 64]");
+
+//epochstat表的统计周期（秒），默认按天统计，按周统计时改为604800
+#define STAT_EPOCH 86400
+
+//gc统计回收的RAM时每行额外计入的字节数，与链上按行计费的开销一致
+#define ROW_OVERHEAD 112
+
+//global.merkle_root = sha256(受保余额树的根 || 互助贡献树的根)，两棵树的哈希规则见merkle.hpp
+#define MERKLE_BALANCE_TREE 0
+#define MERKLE_CONTRIB_TREE 1
+
 using namespace eosio;
 using std::string;
 using namespace std;
 
 typedef double real_type;
+
+//表中符号固定的资产字段只存储金额
+typedef fixed_asset<TOKEN_SYMBOL>   token_asset;
+typedef fixed_asset<KEY_SYMBOL>     key_asset;
+typedef fixed_asset<STAKE_SYMBOL>   stake_asset;
+typedef fixed_asset<KEYCORE_SYMBOL> keycore_asset;
 struct transfer_args
 {
     account_name from;
@@ -31,11 +59,24 @@ class medishares: public eosio::contract{
   public:
     medishares(account_name self):
     contract(self),
-    global(_self, _self),
     keymarket(_self, _self),
+    global(_self, _self),
     cases(_self, _self),
-    accounts(_self, _self)
-    {}
+    casearchive(_self, _self),
+    archdigest(_self, _self),
+    settlements(_self, _self),
+    shardstat(_self, _self),
+    epochstat(_self, _self),
+    gcstate(_self, _self),
+    reshardstat(_self, _self),
+    merkletree(_self, _self),
+    merklenode(_self, _self),
+    merkleleaf(_self, _self)
+    {
+        for(uint64_t shard = 0; shard < ACCOUNT_SHARDS; shard ++){
+            account_shards.emplace_back(_self, _self + shard);
+        }
+    }
 
     ///@abi action
     void init(uint64_t guarantee_rate, uint64_t ref_rate, asset max_claim, time time_for_observation, time time_for_announcement, time min_apply_interval, time time_for_vote, string rule_hash);
@@ -67,41 +108,69 @@ class medishares: public eosio::contract{
     ///@abi action
     void execproposal(account_name account, uint64_t case_id);
 
+    ///@abi action
+    void settleshard(account_name account, uint64_t case_id, uint64_t shard);
+
     ///@abi action
     void delproposal(account_name account, uint64_t case_id);
 
     ///@abi action
     void updaterule(string rule_hash);
 
+    ///@abi action
+    void migrate(uint64_t max_rows);
+
+    ///@abi action
+    void reshard(uint64_t max_rows);
+
+    ///@abi action
+    void gc(uint64_t max_rows);
+
+    ///@abi action
+    void archive(uint64_t case_id);
+
+    ///@abi action
+    void receipt(uint64_t case_id, asset vote_yes, asset vote_no, asset key_supply, asset vote_funding, uint64_t user_num, asset single_amount, asset transfer_fund);
+
     inline asset get_balance(account_name owner, symbol_name sym)const;
 
-    void handleTransfer(const account_name from, const account_name to, const asset& quantity, string memo);
+    void handleTransfer(const account_name from, const account_name to, const asset& quantity, const string& memo);
+
+    void check_shards();
+
+    void update_merkle_root();
 
   private:
-    ///@abi table
+    friend struct medishares_rows;  //tools/native/rows.cpp按本类的表结构解码表行
+    friend struct medishares_bancor;  //tools/mdsbancor.cpp直接调用keymarket::convert核对兑换结果
+
+    ///@abi table keymarket2 i64
     struct keymarket {
-        asset    supply;
+        keycore_asset supply;
 
+        template<symbol_name Symbol>
         struct connector {
-            asset balance;
-            double weight = .5;
+            fixed_asset<Symbol> balance;
+            static constexpr double weight = .5;
 
-            EOSLIB_SERIALIZE( connector, (balance)(weight) )
+            EOSLIB_SERIALIZE( connector, (balance) )
         };
 
-        connector base;
-        connector quote;
+        connector<KEY_SYMBOL>   base;
+        connector<TOKEN_SYMBOL> quote;
 
         uint64_t primary_key()const { return supply.symbol; }
 
-        asset convert_to_exchange( connector& c, asset in );
-        asset convert_from_exchange( connector& c, asset in );
+        template<typename Connector>
+        asset convert_to_exchange( Connector& c, asset in );
+        template<typename Connector>
+        asset convert_from_exchange( Connector& c, asset in );
         asset convert( asset from, symbol_type to );
 
         EOSLIB_SERIALIZE( keymarket, (supply)(base)(quote) )
     };
 
-    eosio::multi_index<N(keymarket), keymarket> keymarket;
+    eosio::multi_index<N(keymarket2), keymarket> keymarket;
 
     struct asset_entry{
         asset    balance;          //KEY:可用数KEY数，SKEY:冻结KEY数，EOS:保障余额
@@ -129,73 +198,364 @@ class medishares: public eosio::contract{
         account_name    account;          //账户名
         time            join_time = 0;    //加入互助保障时间
         time            latest_apply_time = 0;    //最近申请互助时间
-        vector<asset_entry> asset_list;   //资产列表
-        vector<vote_entry> vote_list;     //投票列表
+        arena_vector<asset_entry> asset_list;   //资产列表
+        arena_vector<vote_entry> vote_list;     //投票列表
+        account_name    ram_payer = 0;    //最近一次写入本行的RAM付费账户，0表示未知
 
         uint64_t primary_key()const {return account;}
 
-        EOSLIB_SERIALIZE(accounts, (account)(join_time)(latest_apply_time)(asset_list)(vote_list));
+        template<typename DataStream>
+        friend DataStream& operator << (DataStream& ds, const accounts& a){
+            return ds << a.account << a.join_time << a.latest_apply_time << a.asset_list << a.vote_list << a.ram_payer;
+        }
+        //加入ram_payer之前写入的行没有该字段
+        template<typename DataStream>
+        friend DataStream& operator >> (DataStream& ds, accounts& a){
+            ds >> a.account >> a.join_time >> a.latest_apply_time >> a.asset_list >> a.vote_list;
+            a.ram_payer = 0;
+            if(ds.remaining() >= sizeof(a.ram_payer)){
+                ds >> a.ram_payer;
+            }
+            return ds;
+        }
     };
 
-    eosio::multi_index<N(accounts), accounts> accounts;
+    //写入时记录付费账户，reshard移动行时沿用该账户计费
+    struct accounts_index : eosio::multi_index<N(accounts), accounts> {
+        typedef eosio::multi_index<N(accounts), accounts> base;
+        using base::base;
+
+        template<typename Lambda>
+        const_iterator emplace(account_name payer, Lambda&& constructor){
+            return base::emplace(payer, [&](auto& a){
+                constructor(a);
+                a.ram_payer = payer;
+            });
+        }
+        template<typename Lambda>
+        void modify(const_iterator itr, account_name payer, Lambda&& updater){
+            eosio_assert(itr != end(), "cannot pass end iterator to modify");
+            modify(*itr, payer, std::forward<Lambda>(updater));
+        }
+        template<typename Lambda>
+        void modify(const accounts& obj, account_name payer, Lambda&& updater){
+            base::modify(obj, payer, [&](auto& a){
+                updater(a);
+                if(payer != 0){
+                    a.ram_payer = payer;
+                }
+            });
+        }
+    };
+    std::deque<accounts_index> account_shards;
 
-    ///@abi table
+    //账户名的低位通常为0，取乘积的高32位再按比例映射到分片，不能直接取模
+    static uint64_t shard_of(account_name owner) {
+        return (((owner * 0x9E3779B97F4A7C15ull) >> 32) * ACCOUNT_SHARDS) >> 32;
+    }
+    accounts_index& accounts_of(account_name owner) { return account_shards[shard_of(owner)]; }
+
+    ///@abi table global2 i64
     struct global
     {
         uint64_t     ref_rate;        //推荐分割比例（千分之）
         uint64_t     guarantee_rate;  //保障池分割比例（千分之）
-        asset        guarantee_pool;  //保障池余额
-        asset        bonus_pool;      //分红池余额
+        token_asset  guarantee_pool;  //保障池余额
+        token_asset  bonus_pool;      //分红池余额
         uint64_t     cases_num;       //发起的互助项目总数
         uint64_t     applied_cases;   //申请成功的项目数
         uint64_t     guaranteed_accounts;  //当前受保用户总数
-        asset        max_claim;       //单个互助项目可申请的最大token数量
+        token_asset  max_claim;       //单个互助项目可申请的最大token数量
         time         min_apply_interval;   //申请互助的最小时间间隔
         time         time_for_vote;   //投票时间窗口
         time         time_for_observation; //观察期
         time         time_for_announcement;//公示期
-        asset        total_key;       //全局key数
-        asset        total_skey;      //全局skey数
-        asset        tatal_donate;    //已互助总金额
+        key_asset    total_key;       //全局key数
+        stake_asset  total_skey;      //全局skey数
+        token_asset  total_donate;    //已互助总金额
         string       rule_hash;       //互助参与规则的IPFS Hash
+        checksum256  merkle_root;     //受保余额及互助贡献的Merkle根
+        uint64_t     shards;          //accounts表及shardstat当前对应的分片数，0表示尚未统计或正在reshard
 
         auto primary_key()const{return 0;}
-        EOSLIB_SERIALIZE(global, (ref_rate)(guarantee_rate)(guarantee_pool)(bonus_pool)(cases_num)(applied_cases)(guaranteed_accounts)(max_claim)(min_apply_interval)(time_for_vote)(time_for_observation)(time_for_announcement)(total_key)(total_skey)(tatal_donate)(rule_hash))
+        EOSLIB_SERIALIZE(global, (ref_rate)(guarantee_rate)(guarantee_pool)(bonus_pool)(cases_num)(applied_cases)(guaranteed_accounts)(max_claim)(min_apply_interval)(time_for_vote)(time_for_observation)(time_for_announcement)(total_key)(total_skey)(total_donate)(rule_hash)(merkle_root)(shards))
     };
-    eosio::multi_index<N(global), global> global;
+    eosio::multi_index<N(global2), global> global;
 
     struct aid_entry{
         account_name account;      //互助账号
-        asset        aid_quantity; //互助金额
+        token_asset  aid_quantity; //互助金额
     };
 
-    ///@abi table
+    ///@abi table cases2 i64
     struct cases
     {
         uint64_t        case_id;        //互助项目编号
         checksum256     case_digest;    //项目hash
         account_name    proposer;       //互助申请账号
-        asset           required_fund;  //请求的资助金额
+        token_asset     required_fund;  //请求的资助金额
         time            start_time;     //开始时间
         time            exec_time;      //互助划款时间
-        asset           vote_yes;       //投赞成的SKEY数
-    asset           vote_no;        //投反对的SKEY数
-        asset           transfer_fund;  //实际划款金额
-        vector<aid_entry> aid_list;     //均摊列表
+        stake_asset     vote_yes;       //投赞成的SKEY数
+        stake_asset     vote_no;        //投反对的SKEY数
+        token_asset     transfer_fund;  //实际划款金额
+        arena_vector<aid_entry> aid_list;     //均摊列表
 
         auto primary_key()const{return case_id;}
         EOSLIB_SERIALIZE(cases, (case_id)(case_digest)(proposer)(required_fund)(start_time)(exec_time)(vote_yes)(vote_no)(transfer_fund)(aid_list))
     };
-    eosio::multi_index<N(cases), cases> cases;
+    eosio::multi_index<N(cases2), cases> cases;
+
+    //公示期结束后归档的互助项目，均摊列表只保留人数及Merkle根，每行定长
+    ///@abi table
+    struct casearchive
+    {
+        uint64_t        case_id;        //互助项目编号
+        checksum256     case_digest;    //项目hash
+        account_name    proposer;       //互助申请账号
+        token_asset     required_fund;  //请求的资助金额
+        time            start_time;     //开始时间
+        time            exec_time;      //互助划款时间
+        stake_asset     vote_yes;       //投赞成的SKEY数
+        stake_asset     vote_no;        //投反对的SKEY数
+        token_asset     transfer_fund;  //实际划款金额
+        uint64_t        contributors;   //均摊人数
+        checksum256     aid_root;       //均摊列表的Merkle根，与互助贡献树中该项目的叶子对应
+
+        auto primary_key()const{return case_id;}
+        EOSLIB_SERIALIZE(casearchive, (case_id)(case_digest)(proposer)(required_fund)(start_time)(exec_time)(vote_yes)(vote_no)(transfer_fund)(contributors)(aid_root))
+    };
+    eosio::multi_index<N(casearchive), casearchive> casearchive;
+
+    //已归档项目的摘要索引，propose据此拒绝重复的项目而不必遍历casearchive
+    ///@abi table
+    struct archdigest
+    {
+        uint64_t        digest_key;     //项目hash的前8字节，与其他项目冲突时顺延到下一个空闲值
+        checksum256     case_digest;    //项目hash
+        uint64_t        case_id;        //互助项目编号
+
+        auto primary_key()const{return digest_key;}
+        EOSLIB_SERIALIZE(archdigest, (digest_key)(case_digest)(case_id))
+    };
+    eosio::multi_index<N(archdigest), archdigest> archdigest;
+
+    ///@abi table
+    struct settlements
+    {
+        uint64_t        case_id;        //互助项目编号
+        asset           vote_funding;   //按投票比例计算的资助金额
+        uint64_t        user_num;       //参与均摊的受保用户数
+        asset           single_amount;  //每个受保用户的均摊金额
+        uint64_t        remainder;      //尚未分配的均摊余数（最小单位数）
+        uint64_t        settled_shards; //已完成结算的分片位图
+        asset           transfer_fund;  //已扣划的金额
+        time            start_time;     //开始结算的时间，此时及此后加入受保的用户不参与本项目均摊
+
+        auto primary_key()const{return case_id;}
+        EOSLIB_SERIALIZE(settlements, (case_id)(vote_funding)(user_num)(single_amount)(remainder)(settled_shards)(transfer_fund)(start_time))
+    };
+    eosio::multi_index<N(settlements), settlements> settlements;
+
+    ///@abi table
+    struct shardstat
+    {
+        uint64_t        shard;                //分片编号
+        uint64_t        guaranteed_accounts;  //分片内受保用户数
+        asset           guarantee_pool;       //分片内保障余额合计
+
+        auto primary_key()const{return shard;}
+        EOSLIB_SERIALIZE(shardstat, (shard)(guaranteed_accounts)(guarantee_pool))
+    };
+    eosio::multi_index<N(shardstat), shardstat> shardstat;
+
+    ///@abi table
+    struct epochstat
+    {
+        uint64_t        epoch;                 //统计周期编号，now() / STAT_EPOCH
+        token_asset     deposit;               //存入金额
+        token_asset     guarantee_in;          //进入保障池的金额
+        uint64_t        new_members = 0;       //新加入的受保用户数
+        uint64_t        exited_members = 0;    //保障余额用尽退出的受保用户数
+        key_asset       key_issued;            //存入时发行的KEY数
+        key_asset       key_sold;              //卖出的KEY数
+        token_asset     sell_proceeds;         //卖出KEY得到的金额
+        stake_asset     key_staked;            //冻结的KEY数
+        stake_asset     key_unstaked;          //解冻的SKEY数
+        uint64_t        proposals = 0;         //发起的互助申请数
+        token_asset     required_fund;         //申请的资助金额合计
+        uint64_t        votes = 0;             //投票次数（赞成、反对及改票）
+        stake_asset     vote_skey;             //投票使用的SKEY数
+        uint64_t        cancelled_votes = 0;   //取消投票次数
+        stake_asset     cancelled_skey;        //取消投票撤回的SKEY数
+        uint64_t        paid_cases = 0;        //完成划款的互助项目数
+        token_asset     payouts;               //互助划款金额
+
+        auto primary_key()const{return epoch;}
+        EOSLIB_SERIALIZE(epochstat, (epoch)(deposit)(guarantee_in)(new_members)(exited_members)(key_issued)(key_sold)(sell_proceeds)(key_staked)(key_unstaked)(proposals)(required_fund)(votes)(vote_skey)(cancelled_votes)(cancelled_skey)(paid_cases)(payouts))
+    };
+    eosio::multi_index<N(epochstat), epochstat> epochstat;
+
+    ///@abi table
+    struct gcstate
+    {
+        uint64_t        id = 0;
+        uint64_t        shard = 0;            //下次gc遍历的accounts分片
+        account_name    cursor = 0;           //下次gc在该分片中开始遍历的账户
+        uint64_t        rounds = 0;           //已完整遍历所有分片的次数
+        uint64_t        erased_rows = 0;      //累计删除的行数
+        uint64_t        compacted_rows = 0;   //累计压缩的行数
+        uint64_t        reclaimed_bytes = 0;  //累计回收的RAM字节数
+        uint64_t        last_reclaimed = 0;   //最近一次gc回收的RAM字节数
+
+        auto primary_key()const{return id;}
+        EOSLIB_SERIALIZE(gcstate, (id)(shard)(cursor)(rounds)(erased_rows)(compacted_rows)(reclaimed_bytes)(last_reclaimed))
+    };
+    eosio::multi_index<N(gcstate), gcstate> gcstate;
+
+    //reshard的进度，遍历开始时创建，完成后删除
+    ///@abi table
+    struct reshardstat
+    {
+        uint64_t        id = 0;
+        uint64_t        scope = 0;            //下次遍历的accounts scope（相对_self的偏移）
+        account_name    cursor = 0;           //下次在该scope中开始遍历的账户
+        uint64_t        moved_rows = 0;       //本次遍历中移到其他分片的行数
+        account_name    waiting_payer = 0;    //下一行的RAM付费账户未授权本次reshard时记录该账户
+
+        auto primary_key()const{return id;}
+        EOSLIB_SERIALIZE(reshardstat, (id)(scope)(cursor)(moved_rows)(waiting_payer))
+    };
+    eosio::multi_index<N(reshardstat), reshardstat> reshardstat;
+
+    ///@abi table
+    struct merkletree
+    {
+        uint64_t        tree;      //0:受保余额树，1:互助贡献树
+        uint64_t        leaves;    //叶子数，即已使用的最大叶子编号加1
+        uint64_t        depth;     //树高
+        checksum256     root;      //树根
+
+        auto primary_key()const{return tree;}
+        EOSLIB_SERIALIZE(merkletree, (tree)(leaves)(depth)(root))
+    };
+    eosio::multi_index<N(merkletree), merkletree> merkletree;
+
+    ///@abi table
+    struct merklenode
+    {
+        uint64_t        id;        //树编号 << 62 | 层 << 56 | 层内编号，叶子为第0层
+        checksum256     hash;
+
+        auto primary_key()const{return id;}
+        EOSLIB_SERIALIZE(merklenode, (id)(hash))
+    };
+    eosio::multi_index<N(merklenode), merklenode> merklenode;
+
+    ///@abi table
+    struct merkleleaf
+    {
+        account_name    account;   //受保余额树中的账户
+        uint64_t        index;     //叶子编号，按首次变动保障余额的顺序分配
+
+        auto primary_key()const{return account;}
+        EOSLIB_SERIALIZE(merkleleaf, (account)(index))
+    };
+    eosio::multi_index<N(merkleleaf), merkleleaf> merkleleaf;
+
+    bool merkle_dirty = false;    //本action是否更新过Merkle树，global.merkle_root尚未同步
+    std::map<uint64_t, checksum256> pending_leaves;  //本action中变动的受保余额树叶子，按叶子编号排序，action结束时统一重算路径
+
+    void update_member_leaf(account_name owner, int64_t balance);
+    void remove_member_leaf(account_name owner);
+    void store_merkle_node(uint64_t tree, uint64_t level, uint64_t index, const checksum256& hash);
+    void update_merkle(uint64_t tree, uint64_t index, const checksum256& leaf);
+    void update_merkle(uint64_t tree, std::map<uint64_t, checksum256>& nodes);
+
+    //旧版本的表结构，资产字段带符号存储；仅在migrate中读取后转存到新表
+    ///@abi table keymarket i64
+    struct legacy_keymarket {
+        asset    supply;
+
+        struct connector {
+            asset balance;
+            double weight = .5;
+
+            EOSLIB_SERIALIZE( connector, (balance)(weight) )
+        };
+
+        connector base;
+        connector quote;
+
+        uint64_t primary_key()const { return supply.symbol; }
+
+        EOSLIB_SERIALIZE( legacy_keymarket, (supply)(base)(quote) )
+    };
+
+    ///@abi table global i64
+    struct legacy_global
+    {
+        uint64_t     ref_rate;
+        uint64_t     guarantee_rate;
+        asset        guarantee_pool;
+        asset        bonus_pool;
+        uint64_t     cases_num;
+        uint64_t     applied_cases;
+        uint64_t     guaranteed_accounts;
+        asset        max_claim;
+        time         min_apply_interval;
+        time         time_for_vote;
+        time         time_for_observation;
+        time         time_for_announcement;
+        asset        total_key;
+        asset        total_skey;
+        asset        tatal_donate;
+        string       rule_hash;
+
+        auto primary_key()const{return 0;}
+        EOSLIB_SERIALIZE(legacy_global, (ref_rate)(guarantee_rate)(guarantee_pool)(bonus_pool)(cases_num)(applied_cases)(guaranteed_accounts)(max_claim)(min_apply_interval)(time_for_vote)(time_for_observation)(time_for_announcement)(total_key)(total_skey)(tatal_donate)(rule_hash))
+    };
+
+    struct legacy_aid_entry{
+        account_name account;
+        asset        aid_quantity;
+    };
+
+    ///@abi table cases i64
+    struct legacy_cases
+    {
+        uint64_t        case_id;
+        checksum256     case_digest;
+        account_name    proposer;
+        asset           required_fund;
+        time            start_time;
+        time            exec_time;
+        asset           vote_yes;
+        asset           vote_no;
+        asset           transfer_fund;
+        arena_vector<legacy_aid_entry> aid_list;
+
+        auto primary_key()const{return case_id;}
+        EOSLIB_SERIALIZE(legacy_cases, (case_id)(case_digest)(proposer)(required_fund)(start_time)(exec_time)(vote_yes)(vote_no)(transfer_fund)(aid_list))
+    };
+
+    bool find_archived_digest(const checksum256& digest, uint64_t& free_key);
+    void update_shardstat(uint64_t shard, int64_t accounts_delta, int64_t pool_delta);
+    template<typename Lambda>
+    void update_epochstat(Lambda&& updater);
+    void settle_shard(account_name account, uint64_t case_id, uint64_t shard);
 
     //void handleTransfer(const account_name from, const account_name to, const asset& quantity, string memo);
 };
 
+//tools/native/rows.cpp、tools/mdsbancor.cpp只使用表结构，定义该宏以免与medishares.cpp中的apply重复
+#ifndef MEDISHARES_NO_APPLY
 extern "C"
 {
     void apply(uint64_t receiver, uint64_t code, uint64_t action)
     {
         auto self = receiver;
+        arena::reset();
         if( action == N(onerror)) {
             /* onerror is only valid if it is for the "eosio" code account and authorized by "eosio"'s "active permission */
             eosio_assert(code == N(eosio), "onerror action's are only valid from the \"eosio\" system account");
@@ -204,9 +564,13 @@ extern "C"
         medishares thiscontract(self);
         if (code == self || action == N(onerror))
         {   // Action is pushed directly to the contract
+            if (action != N(init) && action != N(migrate) && action != N(reshard) && action != N(updaterule))
+            {
+                thiscontract.check_shards();
+            }
             switch (action)
             {
-                EOSIO_API(medishares, (init)(transfer)(sellkey)(stakekey)(unstakekey)(propose)(approve)(unapprove)(cancelvote)(execproposal)(delproposal)(updaterule))
+                EOSIO_API(medishares, (init)(transfer)(sellkey)(stakekey)(unstakekey)(propose)(approve)(unapprove)(cancelvote)(execproposal)(settleshard)(delproposal)(updaterule)(migrate)(reshard)(gc)(archive)(receipt))
             }
         }
         else if (code == TOKEN_CONTRACT && action == N(transfer))
@@ -214,6 +578,7 @@ extern "C"
             auto transferData = unpack_action_data<transfer_args>();
             if (transferData.to == self)
             {
+                thiscontract.check_shards();
                 thiscontract.handleTransfer(transferData.from, transferData.to, transferData.quantity, transferData.memo);
             }
         }
@@ -221,6 +586,8 @@ extern "C"
         {
             eosio_assert(false, "reject recepient from other contracts");
         }
+        thiscontract.update_merkle_root();
     }
 }
+#endif
 
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <eosiolib/crypto.h>
+#include <eosiolib/eosio.hpp>
+
+//二叉Merkle树的哈希规则，合约与tools/mdsproof使用同一套规则：
+//  叶子数n的树高为满足2^depth >= n的最小depth，不足的叶子按全0哈希补齐；
+//  父节点 = sha256(左 || 右)，左右都是全0哈希时父节点也取全0哈希，空子树不需要计算和存储。
+//整数按小端8字节参与哈希。
+
+inline bool merkle_is_zero(const checksum256& h) {
+    for(int i = 0; i < 32; i ++){
+        if(h.hash[i] != 0) return false;
+    }
+    return true;
+}
+
+inline checksum256 merkle_zero() {
+    checksum256 h;
+    memset(h.hash, 0, sizeof(h.hash));
+    return h;
+}
+
+inline checksum256 merkle_parent(const checksum256& left, const checksum256& right) {
+    if(merkle_is_zero(left) && merkle_is_zero(right)) return merkle_zero();
+    char buf[64];
+    memcpy(buf, left.hash, 32);
+    memcpy(buf + 32, right.hash, 32);
+    checksum256 h;
+    sha256(buf, sizeof(buf), &h);
+    return h;
+}
+
+//受保余额树的叶子：sha256(账户名 || 保障余额)；互助项目均摊列表的叶子：sha256(账户名 || 均摊金额)
+inline checksum256 merkle_leaf(uint64_t account, int64_t amount) {
+    char buf[16];
+    memcpy(buf, &account, 8);
+    memcpy(buf + 8, &amount, 8);
+    checksum256 h;
+    sha256(buf, sizeof(buf), &h);
+    return h;
+}
+
+//互助贡献树的叶子：sha256(项目编号 || 均摊列表的Merkle根)
+inline checksum256 merkle_case_leaf(uint64_t case_id, const checksum256& aid_root) {
+    char buf[40];
+    memcpy(buf, &case_id, 8);
+    memcpy(buf + 8, aid_root.hash, 32);
+    checksum256 h;
+    sha256(buf, sizeof(buf), &h);
+    return h;
+}
+
+inline uint64_t merkle_depth(uint64_t leaves) {
+    uint64_t depth = 0;
+    while(depth < 56 && (1ull << depth) < leaves) depth ++;
+    return depth;
+}
+
+//由全部叶子逐层归约得到根，hashes会被改写；奇数个节点时最后一个与全0哈希配对，结果与补齐到2^depth个叶子相同
+template<typename Hashes>
+checksum256 merkle_root(Hashes& hashes) {
+    if(hashes.size() == 0) return merkle_zero();
+    size_t n = hashes.size();
+    while(n > 1){
+        size_t parents = (n + 1) / 2;
+        for(size_t i = 0; i < parents; i ++){
+            hashes[i] = merkle_parent(hashes[2 * i], 2 * i + 1 < n ? hashes[2 * i + 1] : merkle_zero());
+        }
+        n = parents;
+    }
+    return hashes[0];
+}
@@ -0,0 +1,289 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+//bancor兑换中用到的幂函数，按部署时链接的musl pow（fdlibm e_pow.c）逐句移植，只使用加减乘除与位操作。
+//兑换结果须与此前调用std::pow时逐位一致，不能用log/exp级数等其他方法代替，修改后须用tools/mdsbancor核对。
+
+#define REAL_HIGH_WORD(d) ((int32_t)(real_bits(d) >> 32))
+#define REAL_LOW_WORD(d) ((uint32_t)real_bits(d))
+
+inline uint64_t real_bits(double d) {
+    uint64_t u;
+    memcpy(&u, &d, 8);
+    return u;
+}
+
+inline double real_from_bits(uint64_t u) {
+    double d;
+    memcpy(&d, &u, 8);
+    return d;
+}
+
+inline void real_set_high_word(double& d, uint32_t hi) {
+    d = real_from_bits((real_bits(d) & 0xffffffffull) | (uint64_t(hi) << 32));
+}
+
+inline void real_set_low_word(double& d, uint32_t lo) {
+    d = real_from_bits((real_bits(d) & 0xffffffff00000000ull) | lo);
+}
+
+inline double real_fabs(double x) {
+    return real_from_bits(real_bits(x) & 0x7fffffffffffffffull);
+}
+
+//x * 2^n，同musl scalbn；n < -1022时先乘2^-969再补足，避免结果为非规格化数时两次舍入
+inline double real_scalbn(double x, int n) {
+    const double two1023 = real_from_bits(0x7fe0000000000000ull);
+    const double twom969 = real_from_bits(0x0360000000000000ull);
+    double y = x;
+    if(n > 1023){
+        y *= two1023;
+        n -= 1023;
+        if(n > 1023){
+            y *= two1023;
+            n -= 1023;
+            if(n > 1023) n = 1023;
+        }
+    }else if(n < -1022){
+        y *= twom969;
+        n += 1022 - 53;
+        if(n < -1022){
+            y *= twom969;
+            n += 1022 - 53;
+            if(n < -1022) n = -1022;
+        }
+    }
+    return y * real_from_bits(uint64_t(0x3ff + n) << 52);
+}
+
+//x^y，同musl pow
+inline double real_pow(double x, double y) {
+    static const double bp[] = {1.0, 1.5};
+    static const double dp_h[] = {0.0, 5.84962487220764160156e-01};
+    static const double dp_l[] = {0.0, 1.35003920212974897128e-08};
+    static const double two53 = 9007199254740992.0;
+    static const double huge = 1.0e300;
+    static const double tiny = 1.0e-300;
+    static const double L1 = 5.99999999999994648725e-01;
+    static const double L2 = 4.28571428578550184252e-01;
+    static const double L3 = 3.33333329818377432918e-01;
+    static const double L4 = 2.72728123808534006489e-01;
+    static const double L5 = 2.30660745775561754067e-01;
+    static const double L6 = 2.06975017800338417784e-01;
+    static const double P1 = 1.66666666666666019037e-01;
+    static const double P2 = -2.77777777770155933842e-03;
+    static const double P3 = 6.61375632143793436117e-05;
+    static const double P4 = -1.65339022054652515390e-06;
+    static const double P5 = 4.13813679705723846039e-08;
+    static const double lg2 = 6.93147180559945286227e-01;
+    static const double lg2_h = 6.93147182464599609375e-01;
+    static const double lg2_l = -1.90465429995776804525e-09;
+    static const double ovt = 8.0085662595372944372e-17;
+    static const double cp = 9.61796693925975554329e-01;
+    static const double cp_h = 9.61796700954437255859e-01;
+    static const double cp_l = -7.02846165095275826516e-09;
+    static const double ivln2 = 1.44269504088896338700e+00;
+    static const double ivln2_h = 1.44269502162933349609e+00;
+    static const double ivln2_l = 1.92596299112661746887e-08;
+
+    double z, ax, z_h, z_l, p_h, p_l;
+    double y1, t1, t2, r, s, t, u, v, w;
+    int32_t i, j, k, yisint, n;
+    int32_t hx, hy, ix, iy;
+    uint32_t lx, ly;
+
+    hx = REAL_HIGH_WORD(x);
+    lx = REAL_LOW_WORD(x);
+    hy = REAL_HIGH_WORD(y);
+    ly = REAL_LOW_WORD(y);
+    ix = hx & 0x7fffffff;
+    iy = hy & 0x7fffffff;
+
+    //x^0 = 1，1^y = 1，即使另一参数为NaN
+    if((iy | ly) == 0) return 1.0;
+    if(hx == 0x3ff00000 && lx == 0) return 1.0;
+    if(ix > 0x7ff00000 || (ix == 0x7ff00000 && lx != 0) ||
+       iy > 0x7ff00000 || (iy == 0x7ff00000 && ly != 0)){
+        return x + y;
+    }
+
+    //x < 0时判断y是否为整数：0非整数，1奇数，2偶数
+    yisint = 0;
+    if(hx < 0){
+        if(iy >= 0x43400000){
+            yisint = 2;
+        }else if(iy >= 0x3ff00000){
+            k = (iy >> 20) - 0x3ff;
+            if(k > 20){
+                uint32_t jj = ly >> (52 - k);
+                if((jj << (52 - k)) == ly) yisint = 2 - (jj & 1);
+            }else if(ly == 0){
+                uint32_t jj = iy >> (20 - k);
+                if((jj << (20 - k)) == (uint32_t)iy) yisint = 2 - (jj & 1);
+            }
+        }
+    }
+
+    //y的特殊值
+    if(ly == 0){
+        if(iy == 0x7ff00000){
+            if(((ix - 0x3ff00000) | lx) == 0) return 1.0;
+            else if(ix >= 0x3ff00000) return hy >= 0 ? y : 0.0;
+            else return hy >= 0 ? 0.0 : -y;
+        }
+        if(iy == 0x3ff00000){
+            if(hy >= 0) return x;
+            return 1 / x;
+        }
+        if(hy == 0x40000000) return x * x;
+        if(hy == 0x3fe00000){
+            if(hx >= 0) return __builtin_sqrt(x);
+        }
+    }
+
+    ax = real_fabs(x);
+    //x为±0、±inf、±1
+    if(lx == 0){
+        if(ix == 0x7ff00000 || ix == 0 || ix == 0x3ff00000){
+            z = ax;
+            if(hy < 0) z = 1.0 / z;
+            if(hx < 0){
+                if(((ix - 0x3ff00000) | yisint) == 0){
+                    z = (z - z) / (z - z);
+                }else if(yisint == 1){
+                    z = -z;
+                }
+            }
+            return z;
+        }
+    }
+
+    s = 1.0;
+    if(hx < 0){
+        if(yisint == 0) return (x - x) / (x - x);
+        if(yisint == 1) s = -1.0;
+    }
+
+    if(iy > 0x41e00000){
+        //|y| > 2^31
+        if(iy > 0x43f00000){
+            if(ix <= 0x3fefffff) return hy < 0 ? huge * huge : tiny * tiny;
+            if(ix >= 0x3ff00000) return hy > 0 ? huge * huge : tiny * tiny;
+        }
+        if(ix < 0x3fefffff) return hy < 0 ? s * huge * huge : s * tiny * tiny;
+        if(ix > 0x3ff00000) return hy > 0 ? s * huge * huge : s * tiny * tiny;
+        //|1-x| <= 2^-20，log(x)取x-x^2/2+x^3/3-x^4/4
+        t = ax - 1.0;
+        w = (t * t) * (0.5 - t * (0.3333333333333333333333 - t * 0.25));
+        u = ivln2_h * t;
+        v = t * ivln2_l - w * ivln2;
+        t1 = u + v;
+        real_set_low_word(t1, 0);
+        t2 = v - (t1 - u);
+    }else{
+        double ss, s2, s_h, s_l, t_h, t_l;
+        n = 0;
+        //非规格化数
+        if(ix < 0x00100000){
+            ax *= two53;
+            n -= 53;
+            ix = REAL_HIGH_WORD(ax);
+        }
+        n += (ix >> 20) - 0x3ff;
+        j = ix & 0x000fffff;
+        ix = j | 0x3ff00000;
+        if(j <= 0x3988E){
+            k = 0;
+        }else if(j < 0xBB67A){
+            k = 1;
+        }else{
+            k = 0;
+            n += 1;
+            ix -= 0x00100000;
+        }
+        real_set_high_word(ax, ix);
+
+        //ss = s_h+s_l = (x-1)/(x+1)或(x-1.5)/(x+1.5)
+        u = ax - bp[k];
+        v = 1.0 / (ax + bp[k]);
+        ss = u * v;
+        s_h = ss;
+        real_set_low_word(s_h, 0);
+        t_h = 0.0;
+        real_set_high_word(t_h, ((ix >> 1) | 0x20000000) + 0x00080000 + (k << 18));
+        t_l = ax - (t_h - bp[k]);
+        s_l = v * ((u - s_h * t_h) - s_h * t_l);
+        //log(ax)
+        s2 = ss * ss;
+        r = s2 * s2 * (L1 + s2 * (L2 + s2 * (L3 + s2 * (L4 + s2 * (L5 + s2 * L6)))));
+        r += s_l * (s_h + ss);
+        s2 = s_h * s_h;
+        t_h = 3.0 + s2 + r;
+        real_set_low_word(t_h, 0);
+        t_l = r - ((t_h - 3.0) - s2);
+        u = s_h * t_h;
+        v = s_l * t_h + t_l * ss;
+        p_h = u + v;
+        real_set_low_word(p_h, 0);
+        p_l = v - (p_h - u);
+        z_h = cp_h * p_h;
+        z_l = cp_l * p_h + p_l * cp + dp_l[k];
+        //log2(ax) = n + dp_h + z_h + z_l
+        t = (double)n;
+        t1 = ((z_h + z_l) + dp_h[k]) + t;
+        real_set_low_word(t1, 0);
+        t2 = z_l - (((t1 - t) - dp_h[k]) - z_h);
+    }
+
+    //y拆为y1+y2，计算(y1+y2)*(t1+t2)
+    y1 = y;
+    real_set_low_word(y1, 0);
+    p_l = (y - y1) * t1 + y * t2;
+    p_h = y1 * t1;
+    z = p_l + p_h;
+    j = REAL_HIGH_WORD(z);
+    i = (int32_t)REAL_LOW_WORD(z);
+    if(j >= 0x40900000){
+        //z >= 1024
+        if(((j - 0x40900000) | i) != 0) return s * huge * huge;
+        if(p_l + ovt > z - p_h) return s * huge * huge;
+    }else if((j & 0x7fffffff) >= 0x4090cc00){
+        //z <= -1075
+        if(((j - (int32_t)0xc090cc00) | i) != 0) return s * tiny * tiny;
+        if(p_l <= z - p_h) return s * tiny * tiny;
+    }
+
+    //2^(p_h+p_l)
+    i = j & 0x7fffffff;
+    k = (i >> 20) - 0x3ff;
+    n = 0;
+    if(i > 0x3fe00000){
+        //|z| > 0.5时n = [z+0.5]
+        n = j + (0x00100000 >> (k + 1));
+        k = ((n & 0x7fffffff) >> 20) - 0x3ff;
+        t = 0.0;
+        real_set_high_word(t, n & ~(0x000fffff >> k));
+        n = ((n & 0x000fffff) | 0x00100000) >> (20 - k);
+        if(j < 0) n = -n;
+        p_h -= t;
+    }
+    t = p_l + p_h;
+    real_set_low_word(t, 0);
+    u = t * lg2_h;
+    v = (p_l - (t - p_h)) * lg2 + t * lg2_l;
+    z = u + v;
+    w = v - (z - u);
+    t = z * z;
+    t1 = z - t * (P1 + t * (P2 + t * (P3 + t * (P4 + t * P5))));
+    r = (z * t1) / (t1 - 2.0) - (w + z * w);
+    z = 1.0 - (r - z);
+    j = REAL_HIGH_WORD(z);
+    j += (int32_t)((uint32_t)n << 20);
+    if((j >> 20) <= 0){
+        z = real_scalbn(z, n);
+    }else{
+        real_set_high_word(z, j);
+    }
+    return s * z;
+}
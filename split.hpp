@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include <eosiolib/eosio.hpp>
+
+//整数按比例分割：amount * num / den，使用128位中间值避免溢出，不经过浮点运算
+struct split_result {
+    uint64_t part;       //按比例分得的部分（向下取整）
+    uint64_t remainder;  //整除后剩余的最小单位数，由调用方按确定的顺序分配
+};
+
+inline split_result prorata(uint64_t amount, uint64_t num, uint64_t den) {
+    eosio_assert(den > 0, "split denominator must be positive");
+    unsigned __int128 product = (unsigned __int128)amount * num;
+    unsigned __int128 part = product / den;
+    eosio_assert(part <= UINT64_MAX, "split overflow");
+    return split_result{ (uint64_t)part, (uint64_t)(product % den) };
+}
+
+//将amount平均分给count份，前remainder份各多分1个最小单位，保证各份之和恰好等于amount
+inline split_result split_even(uint64_t amount, uint64_t count) {
+    eosio_assert(count > 0, "split count must be positive");
+    return split_result{ amount / count, amount % count };
+}
@@ -0,0 +1,41 @@
+#!/bin/sh
+# build-lean: 体积优先的medishares.wasm构建及体积预算检查
+#
+# eosiocpp生成.wast后，用binaryen删除apply不可达的导出函数（wasm-metadce），再按-Oz优化（wasm-opt），
+# 输出部署用的medishares.wasm以及保留函数名的medishares.named.wasm，并用mdssize检查体积预算。
+# 需要eosiocpp、binaryen及g++；node可用时顺带用mdsbench测量新构建的实例化耗时，设置BASELINE_WASM时与之对比。
+#
+# 用法：
+#   tools/build-lean.sh [输出目录，默认build-lean]
+# 环境变量WASM_BUDGET为部署wasm的体积预算（字节），超出时返回非0；BASELINE_WASM为对比用的wasm，例如当前链上部署的版本。
+# 默认预算为改用精简构建前部署的medishares.wasm的大小（101073字节），精简构建不得超过它；
+# 在有eosiocpp的环境中得到精简构建的实测大小后，应将默认值改为实测值加少量余量。
+# 仓库中不保存编译产物，部署前须由本脚本或eosiocpp从源码重新生成。
+
+set -e
+cd "$(dirname "$0")/.."
+
+out=${1:-build-lean}
+budget=${WASM_BUDGET:-101073}
+mkdir -p "$out"
+
+eosiocpp -o "$out/medishares.wast" medishares.cpp
+
+# 对外只需要apply与memory，其余导出的函数若apply不可达则一并删除
+cat > "$out/graph.json" <<'EOF'
+[
+  { "name": "apply", "root": true, "export": "apply" },
+  { "name": "memory", "root": true, "export": "memory" }
+]
+EOF
+wasm-metadce "$out/medishares.wast" --graph-file "$out/graph.json" --mvp-features -g -o "$out/dce.wasm"
+wasm-opt "$out/dce.wasm" --mvp-features -Oz --converge -g -o "$out/medishares.named.wasm"
+wasm-opt "$out/medishares.named.wasm" --mvp-features --strip-debug -o "$out/medishares.wasm"
+
+g++ -std=c++17 -O2 -o "$out/mdssize" tools/mdssize.cpp
+"$out/mdssize" --top 30 "$out/medishares.named.wasm"
+"$out/mdssize" --top 0 --budget "$budget" "$out/medishares.wasm"
+
+if command -v node > /dev/null; then
+    node --no-wasm-lazy-compilation tools/mdsbench.js ${BASELINE_WASM:+"$BASELINE_WASM"} "$out/medishares.wasm"
+fi
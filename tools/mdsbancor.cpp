@@ -0,0 +1,105 @@
+// mdsbancor: keymarket兑换结果的逐位核对工具
+//
+// 读取tools/mdsbancor.js由参照wasm生成的向量，用原生编译的合约代码（keymarket::convert及real_pow）重新计算，
+// 兑换数量、兑换后的市场状态以及pow的位模式须与参照完全一致，不一致时输出前几条并返回非0。
+// tools/replay/bancor.vec由改用real_pow之前部署的medishares.wasm生成，用作回归检查。
+//
+// 编译：g++ -std=c++17 -O2 -Itools/native -o mdsbancor tools/mdsbancor.cpp tools/native/chain.cpp medishares.cpp
+//
+// 用法：
+//   mdsbancor bancor.vec
+//   node tools/mdsbancor.js --count 1000000 reference.wasm | mdsbancor -
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#define MEDISHARES_NO_APPLY
+#include "../medishares.hpp"
+
+using namespace std;
+
+struct medishares_bancor {
+    typedef struct medishares::keymarket keymarket;
+};
+
+//返回空串表示一致，否则为不一致的说明
+static string check_convert(const char* fields){
+    int64_t supply, base, quote, amount, out, supply_after, base_after, quote_after;
+    char from[8];
+    if(sscanf(fields, "%" SCNd64 " %" SCNd64 " %" SCNd64 " %" SCNd64 " %7s %" SCNd64 " %" SCNd64 " %" SCNd64 " %" SCNd64,
+              &supply, &base, &quote, &amount, from, &out, &supply_after, &base_after, &quote_after) != 9){
+        return "malformed convert vector";
+    }
+
+    medishares_bancor::keymarket km;
+    km.supply.amount = supply;
+    km.base.balance.amount = base;
+    km.quote.balance.amount = quote;
+    eosio::asset result;
+    if(strcmp(from, "EMDS") == 0) result = km.convert(eosio::asset(amount, TOKEN_SYMBOL), KEY_SYMBOL);
+    else if(strcmp(from, "KEY") == 0) result = km.convert(eosio::asset(amount, KEY_SYMBOL), TOKEN_SYMBOL);
+    else return string("unknown symbol ") + from;
+
+    if(result.amount == out && km.supply.amount == supply_after && km.base.balance.amount == base_after && km.quote.balance.amount == quote_after){
+        return "";
+    }
+    char msg[256];
+    snprintf(msg, sizeof(msg), "expected %" PRId64 " %" PRId64 " %" PRId64 " %" PRId64 ", got %" PRId64 " %" PRId64 " %" PRId64 " %" PRId64,
+             out, supply_after, base_after, quote_after,
+             result.amount, (int64_t)km.supply.amount, (int64_t)km.base.balance.amount, (int64_t)km.quote.balance.amount);
+    return msg;
+}
+
+static bool is_nan(uint64_t bits){
+    return (bits & 0x7ff0000000000000ull) == 0x7ff0000000000000ull && (bits & 0xfffffffffffffull) != 0;
+}
+
+static string check_pow(const char* fields){
+    uint64_t x, y, expected;
+    if(sscanf(fields, "%" SCNx64 " %" SCNx64 " %" SCNx64, &x, &y, &expected) != 3){
+        return "malformed pow vector";
+    }
+
+    uint64_t got = real_bits(real_pow(real_from_bits(x), real_from_bits(y)));
+    //NaN的符号与载荷不作要求
+    if(got == expected || (is_nan(got) && is_nan(expected))) return "";
+    char msg[64];
+    snprintf(msg, sizeof(msg), "expected %016" PRIx64 ", got %016" PRIx64, expected, got);
+    return msg;
+}
+
+int main(int argc, char** argv){
+    if(argc != 2){
+        fprintf(stderr, "usage: mdsbancor <bancor.vec|->\n");
+        return 1;
+    }
+    FILE* in = strcmp(argv[1], "-") == 0 ? stdin : fopen(argv[1], "r");
+    if(in == nullptr){
+        fprintf(stderr, "can not open %s\n", argv[1]);
+        return 1;
+    }
+
+    uint64_t vectors = 0, mismatches = 0, line_no = 0;
+    char line[512];
+    while(fgets(line, sizeof(line), in) != nullptr){
+        line_no ++;
+        if(line[0] == '\n' || line[0] == '#') continue;
+        string error;
+        try{
+            if(strncmp(line, "convert ", 8) == 0) error = check_convert(line + 8);
+            else if(strncmp(line, "pow ", 4) == 0) error = check_pow(line + 4);
+            else error = "unknown vector";
+        }catch(const std::exception& e){
+            error = e.what();
+        }
+        vectors ++;
+        if(!error.empty() && ++ mismatches <= 10){
+            fprintf(stderr, "line %" PRIu64 ": %s\n", line_no, error.c_str());
+        }
+    }
+    if(in != stdin) fclose(in);
+    printf("%" PRIu64 " vectors, %" PRIu64 " mismatches\n", vectors, mismatches);
+    return mismatches == 0 ? 0 : 2;
+}
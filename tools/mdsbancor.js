@@ -0,0 +1,153 @@
+// mdsbancor: keymarket兑换对照向量的生成工具
+//
+// 在node中加载参照用的medishares.wasm，直接调用其导出的keymarket::convert及pow，对随机的市场状态与兑换数量
+// 输出参照结果，由tools/mdsbancor.cpp用原生编译的合约逐位核对。参照wasm取改用real_pow之前部署的版本，
+// 例如git show b919a58^:medishares.wasm。导入的链上接口除eosio_assert外均以抛出异常的函数代替，
+// 参照模块断言失败的输入不输出。
+//
+// 用法：
+//   node tools/mdsbancor.js [--count N] [--seed S] reference.wasm > bancor.vec
+//
+// 输出格式，每行一个向量，金额为整数，double为16进制位模式：
+//   convert <supply> <base> <quote> <amount> <EMDS|KEY> <out> <supply_after> <base_after> <quote_after>
+//   pow <x> <y> <x^y>
+
+'use strict';
+
+const fs = require('fs');
+
+const CONVERT = '_ZN10medishares9keymarket7convertEN5eosio5assetENS1_11symbol_typeE';
+
+function symbol(precision, name) {
+    let v = BigInt(precision);
+    for (let i = 0; i < name.length; i++) v |= BigInt(name.charCodeAt(i)) << BigInt(8 * (i + 1));
+    return v;
+}
+
+const KEYCORE_SYMBOL = symbol(4, 'KEYCORE');
+const KEY_SYMBOL = symbol(0, 'KEY');
+const TOKEN_SYMBOL = symbol(4, 'EMDS');
+
+//线性同余随机数，固定种子时输出可复现
+function lcg(seed) {
+    let state = BigInt(seed) & 0xffffffffffffn;
+    return () => {
+        state = (state * 0x5deece66dn + 0xbn) & 0xffffffffffffn;
+        return Number(state >> 16n) / 4294967296;
+    };
+}
+
+//[lo, hi]内按对数均匀分布的整数
+function log_uniform(random, lo, hi) {
+    return BigInt(Math.floor(Math.exp(Math.log(lo) + random() * (Math.log(hi) - Math.log(lo)))));
+}
+
+function load(path) {
+    const module = new WebAssembly.Module(fs.readFileSync(path));
+    const env = {};
+    let instance;
+    for (const imp of WebAssembly.Module.imports(module)) {
+        if (imp.kind !== 'function') {
+            throw new Error('unsupported import ' + imp.module + '.' + imp.name + ' (' + imp.kind + ')');
+        }
+        env[imp.name] = () => { throw new Error(imp.name + ' is not available'); };
+    }
+    env.eosio_assert = (test, msg) => {
+        if (test) return;
+        const bytes = new Uint8Array(instance.exports.memory.buffer);
+        let end = msg;
+        while (bytes[end]) end++;
+        throw new Error(Buffer.from(bytes.subarray(msg, end)).toString());
+    };
+    instance = new WebAssembly.Instance(module, { env });
+    if (!instance.exports[CONVERT] || !instance.exports.pow) {
+        throw new Error(path + ' does not export keymarket::convert and pow');
+    }
+    return instance.exports;
+}
+
+//参照模块中keymarket的布局：supply(amount, symbol)，base与quote各为(amount, symbol, weight)
+function convert(exports, market, amount, from_symbol, to_symbol) {
+    const view = new DataView(exports.memory.buffer);
+    const km = exports.memory.buffer.byteLength - 4096;
+    const from = km + 64;
+    const out = km + 96;
+    view.setBigInt64(km, market.supply, true);
+    view.setBigUint64(km + 8, KEYCORE_SYMBOL, true);
+    view.setBigInt64(km + 16, market.base, true);
+    view.setBigUint64(km + 24, KEY_SYMBOL, true);
+    view.setFloat64(km + 32, 0.5, true);
+    view.setBigInt64(km + 40, market.quote, true);
+    view.setBigUint64(km + 48, TOKEN_SYMBOL, true);
+    view.setFloat64(km + 56, 0.5, true);
+    view.setBigInt64(from, amount, true);
+    view.setBigUint64(from + 8, from_symbol, true);
+    exports[CONVERT](out, km, from, to_symbol);
+    return [view.getBigInt64(out, true), view.getBigInt64(km, true), view.getBigInt64(km + 16, true), view.getBigInt64(km + 40, true)];
+}
+
+const scratch = new DataView(new ArrayBuffer(8));
+function bits(d) {
+    scratch.setFloat64(0, d);
+    return scratch.getBigUint64(0).toString(16).padStart(16, '0');
+}
+
+//兑换用到的底数在1附近，指数为0.0005与2000；另取一部分任意的位模式覆盖pow的其余分支
+function pow_input(random) {
+    switch (Math.floor(random() * 4)) {
+    case 0: return [1 + random() * 1e-3, 0.0005];
+    case 1: return [1 + random() * 1e-3, 2000];
+    case 2: return [random() * 1e3, (random() - 0.5) * 2e3];
+    default:
+        scratch.setUint32(0, Math.floor(random() * 4294967296));
+        scratch.setUint32(4, Math.floor(random() * 4294967296));
+        const x = scratch.getFloat64(0);
+        scratch.setUint32(0, Math.floor(random() * 4294967296));
+        scratch.setUint32(4, Math.floor(random() * 4294967296));
+        return [x, scratch.getFloat64(0)];
+    }
+}
+
+function main(argv) {
+    let count = 1000;
+    let seed = 1;
+    let path = null;
+    for (let i = 0; i < argv.length; i++) {
+        if (argv[i] === '--count' && i + 1 < argv.length) count = parseInt(argv[++i], 10);
+        else if (argv[i] === '--seed' && i + 1 < argv.length) seed = parseInt(argv[++i], 10);
+        else path = argv[i];
+    }
+    if (path === null || !(count > 0)) {
+        console.error('usage: node tools/mdsbancor.js [--count N] [--seed S] reference.wasm');
+        process.exit(1);
+    }
+
+    const exports = load(path);
+    const random = lcg(seed);
+    const lines = [];
+    for (let n = 0; n < count; ) {
+        //市场状态在初始值（supply 10^14，base 4*10^8，quote 2*10^10）上下浮动
+        const market = {
+            supply: log_uniform(random, 1e13, 1e15),
+            base: log_uniform(random, 1e6, 1e11),
+            quote: log_uniform(random, 1e8, 1e12)
+        };
+        const buy = random() < 0.5;
+        const amount = buy ? log_uniform(random, 1, 1e10) : log_uniform(random, 1, 1e8);
+        try {
+            const result = buy ? convert(exports, market, amount, TOKEN_SYMBOL, KEY_SYMBOL)
+                               : convert(exports, market, amount, KEY_SYMBOL, TOKEN_SYMBOL);
+            lines.push(['convert', market.supply, market.base, market.quote, amount, buy ? 'EMDS' : 'KEY'].concat(result).join(' '));
+            n++;
+        } catch (e) {
+            if (!(e instanceof Error) || /is not available/.test(e.message)) throw e;
+        }
+    }
+    for (let n = 0; n < count; n++) {
+        const [x, y] = pow_input(random);
+        lines.push(['pow', bits(x), bits(y), bits(exports.pow(x, y))].join(' '));
+    }
+    process.stdout.write(lines.join('\n') + '\n');
+}
+
+main(process.argv.slice(2));
@@ -0,0 +1,420 @@
+// mdsproof: medishares受保余额及互助贡献的Merkle证明生成工具
+//
+// 从合约表的原始二进制行（cleos get table <contract> <scope> <table> -b 输出的rows，每行一个hex串）中取出
+// Merkle树节点，为某个账户生成保障余额证明，或为某个互助项目中某个账户的均摊金额生成贡献证明。
+// 证明由叶子哈希和逐层的兄弟节点组成，验证方只需按merkle.hpp中的规则做depth次sha256即可得到树根，
+// 再与sha256(受保余额树根 || 互助贡献树根)即global2.merkle_root比对。
+//
+// 编译：g++ -std=c++17 -O2 -o mdsproof tools/mdsproof.cpp
+//
+// 用法：
+//   mdsproof member  <merkletree.hex> <merklenode.hex> <merkleleaf.hex> <accounts.hex> <account> [global2.hex]
+//   mdsproof contrib <merkletree.hex> <merklenode.hex> <cases2.hex> <case_id> <account> [global2.hex]
+//   mdsproof archived <merkletree.hex> <merklenode.hex> <casearchive.hex> <case_id> [global2.hex]
+// 已归档的项目只保留均摊列表的Merkle根，archived校验归档行与互助贡献树一致；个人均摊金额的证明需由
+// 历史交易中的均摊列表重新计算aid_root。
+// accounts分片时将各scope的行合并到同一个hex文件。
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "native/sha256.hpp"
+
+using namespace std;
+
+static const uint64_t TOKEN_SYMBOL = uint64_t('E') << 8 | uint64_t('M') << 16 | uint64_t('D') << 24 | uint64_t('S') << 32 | 4;
+
+static const uint64_t BALANCE_TREE = 0;
+static const uint64_t CONTRIB_TREE = 1;
+
+struct hash256 {
+    uint8_t b[32];
+
+    bool zero()const {
+        for(uint8_t c : b) if(c) return false;
+        return true;
+    }
+    bool operator == (const hash256& o)const { return memcmp(b, o.b, 32) == 0; }
+    string hex()const {
+        static const char* digits = "0123456789abcdef";
+        string s;
+        for(uint8_t c : b){
+            s.push_back(digits[c >> 4]);
+            s.push_back(digits[c & 15]);
+        }
+        return s;
+    }
+};
+
+static hash256 zero_hash(){
+    hash256 h;
+    memset(h.b, 0, 32);
+    return h;
+}
+
+static hash256 digest(const void* data, size_t len){
+    hash256 h;
+    native_sha256::digest(data, len, h.b);
+    return h;
+}
+
+//以下三个函数与merkle.hpp中的merkle_parent、merkle_leaf、merkle_case_leaf一致
+static hash256 parent(const hash256& left, const hash256& right){
+    if(left.zero() && right.zero()) return zero_hash();
+    uint8_t buf[64];
+    memcpy(buf, left.b, 32);
+    memcpy(buf + 32, right.b, 32);
+    return digest(buf, 64);
+}
+
+static hash256 leaf(uint64_t account, int64_t amount){
+    uint8_t buf[16];
+    memcpy(buf, &account, 8);
+    memcpy(buf + 8, &amount, 8);
+    return digest(buf, 16);
+}
+
+static hash256 case_leaf(uint64_t case_id, const hash256& aid_root){
+    uint8_t buf[40];
+    memcpy(buf, &case_id, 8);
+    memcpy(buf + 8, aid_root.b, 32);
+    return digest(buf, 40);
+}
+
+static uint64_t string_to_name(const string& str){
+    uint64_t name = 0;
+    auto value_of = [](char c) -> uint64_t {
+        if(c >= 'a' && c <= 'z') return (c - 'a') + 6;
+        if(c >= '1' && c <= '5') return (c - '1') + 1;
+        return 0;
+    };
+    for(size_t i = 0; i < str.size() && i <= 12; ++i){
+        uint64_t c = value_of(str[i]);
+        if(i < 12){
+            c &= 0x1f;
+            c <<= 64 - 5 * (i + 1);
+        }else{
+            c &= 0x0f;
+        }
+        name |= c;
+    }
+    return name;
+}
+
+//按字节读取一行原始数据
+struct row_reader {
+    const uint8_t* pos;
+    const uint8_t* end;
+
+    void need(size_t n){
+        if((size_t)(end - pos) < n) throw runtime_error("row truncated");
+    }
+    template<typename T>
+    T read(){
+        need(sizeof(T));
+        T v;
+        memcpy(&v, pos, sizeof(T));
+        pos += sizeof(T);
+        return v;
+    }
+    hash256 read_hash(){
+        need(32);
+        hash256 h;
+        memcpy(h.b, pos, 32);
+        pos += 32;
+        return h;
+    }
+    uint32_t read_varuint(){
+        uint64_t v = 0;
+        uint8_t b = 0, by = 0;
+        do{
+            need(1);
+            b = *pos++;
+            v |= uint64_t(b & 0x7f) << by;
+            by += 7;
+        }while(b & 0x80);
+        return (uint32_t)v;
+    }
+    void skip(size_t n){
+        need(n);
+        pos += n;
+    }
+};
+
+static int hex_value(char c){
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static vector<vector<uint8_t>> read_hex_rows(const string& path){
+    ifstream in(path);
+    if(!in) throw runtime_error("can not open " + path);
+    vector<vector<uint8_t>> rows;
+    string line;
+    while(getline(in, line)){
+        vector<uint8_t> row;
+        int hi = -1;
+        for(char c : line){
+            int v = hex_value(c);
+            if(v < 0) continue;
+            if(hi < 0){
+                hi = v;
+            }else{
+                row.push_back(uint8_t(hi << 4 | v));
+                hi = -1;
+            }
+        }
+        if(!row.empty()) rows.push_back(move(row));
+    }
+    return rows;
+}
+
+struct tree_info {
+    uint64_t leaves = 0;
+    uint64_t depth = 0;
+    hash256  root = zero_hash();
+};
+
+//merkletree及merklenode表的全部内容
+struct merkle_state {
+    map<uint64_t, tree_info> trees;
+    map<uint64_t, hash256>   nodes;
+
+    merkle_state(const string& tree_path, const string& node_path){
+        for(const auto& row : read_hex_rows(tree_path)){
+            row_reader r{row.data(), row.data() + row.size()};
+            uint64_t tree = r.read<uint64_t>();
+            tree_info info;
+            info.leaves = r.read<uint64_t>();
+            info.depth = r.read<uint64_t>();
+            info.root = r.read_hash();
+            trees[tree] = info;
+        }
+        for(const auto& row : read_hex_rows(node_path)){
+            row_reader r{row.data(), row.data() + row.size()};
+            uint64_t id = r.read<uint64_t>();
+            nodes[id] = r.read_hash();
+        }
+    }
+
+    tree_info tree(uint64_t id)const {
+        auto itr = trees.find(id);
+        return itr == trees.end() ? tree_info() : itr->second;
+    }
+
+    hash256 node(uint64_t tree, uint64_t level, uint64_t index)const {
+        auto itr = nodes.find(tree << 62 | level << 56 | index);
+        return itr == nodes.end() ? zero_hash() : itr->second;
+    }
+};
+
+struct proof_step {
+    hash256 sibling;
+    bool    sibling_left;
+};
+
+//按兄弟节点从叶子逐层计算到根
+static hash256 fold(hash256 h, const vector<proof_step>& path){
+    for(const auto& step : path){
+        h = step.sibling_left ? parent(step.sibling, h) : parent(h, step.sibling);
+    }
+    return h;
+}
+
+static void print_path(const char* label, const vector<proof_step>& path){
+    for(size_t level = 0; level < path.size(); ++level){
+        printf("%s %2zu %c %s\n", label, level, path[level].sibling_left ? 'L' : 'R', path[level].sibling.hex().c_str());
+    }
+}
+
+static vector<proof_step> tree_path(const merkle_state& st, uint64_t tree, uint64_t index){
+    vector<proof_step> path;
+    for(uint64_t level = 0; level < st.tree(tree).depth; ++level){
+        path.push_back(proof_step{st.node(tree, level, index ^ 1), (index & 1) != 0});
+        index >>= 1;
+    }
+    return path;
+}
+
+//global2行：ref_rate至total_donate共104字节定长，其后为rule_hash字符串及merkle_root
+static hash256 read_global_root(const string& path){
+    auto rows = read_hex_rows(path);
+    if(rows.size() != 1) throw runtime_error("global2 must have exactly one row");
+    row_reader r{rows[0].data(), rows[0].data() + rows[0].size()};
+    r.skip(104);
+    r.skip(r.read_varuint());
+    return r.read_hash();
+}
+
+//打印两棵树的根及合并后的根，返回是否与链上数据一致
+static bool print_roots(const merkle_state& st, uint64_t tree, const hash256& computed, const string& global_path){
+    hash256 stored = st.tree(tree).root;
+    printf("tree_root     %s (%s)\n", computed.hex().c_str(), computed == stored ? "matches merkletree" : "MISMATCH with merkletree");
+    hash256 balance_root = tree == BALANCE_TREE ? computed : st.tree(BALANCE_TREE).root;
+    hash256 contrib_root = tree == CONTRIB_TREE ? computed : st.tree(CONTRIB_TREE).root;
+    printf("balance_root  %s\n", balance_root.hex().c_str());
+    printf("contrib_root  %s\n", contrib_root.hex().c_str());
+    hash256 root = parent(balance_root, contrib_root);
+    bool ok = computed == stored;
+    if(global_path.empty()){
+        printf("merkle_root   %s\n", root.hex().c_str());
+    }else{
+        hash256 global_root = read_global_root(global_path);
+        ok = ok && root == global_root;
+        printf("merkle_root   %s (%s)\n", root.hex().c_str(), root == global_root ? "matches global2" : "MISMATCH with global2");
+    }
+    return ok;
+}
+
+static bool member_proof(const merkle_state& st, const string& leaf_path, const string& accounts_path, uint64_t account, const string& global_path){
+    bool found = false;
+    uint64_t index = 0;
+    for(const auto& row : read_hex_rows(leaf_path)){
+        row_reader r{row.data(), row.data() + row.size()};
+        if(r.read<uint64_t>() == account){
+            index = r.read<uint64_t>();
+            found = true;
+        }
+    }
+    if(!found) throw runtime_error("account has no leaf in the balance tree");
+
+    int64_t balance = 0;
+    for(const auto& row : read_hex_rows(accounts_path)){
+        row_reader r{row.data(), row.data() + row.size()};
+        if(r.read<uint64_t>() != account) continue;
+        r.skip(8);
+        for(uint32_t n = r.read_varuint(); n > 0; --n){
+            int64_t amount = r.read<int64_t>();
+            if(r.read<uint64_t>() == TOKEN_SYMBOL) balance = amount;
+        }
+    }
+
+    hash256 h = leaf(account, balance);
+    auto path = tree_path(st, BALANCE_TREE, index);
+    printf("balance       %lld\n", (long long)balance);
+    printf("index         %llu\n", (unsigned long long)index);
+    printf("leaf          %s\n", h.hex().c_str());
+    print_path("sibling", path);
+    return print_roots(st, BALANCE_TREE, fold(h, path), global_path);
+}
+
+static bool contrib_proof(const merkle_state& st, const string& cases_path, uint64_t case_id, uint64_t account, const string& global_path){
+    vector<pair<uint64_t, int64_t>> aid_list;
+    bool found = false;
+    for(const auto& row : read_hex_rows(cases_path)){
+        row_reader r{row.data(), row.data() + row.size()};
+        if(r.read<uint64_t>() != case_id) continue;
+        //case_digest, proposer, required_fund, start_time, exec_time, vote_yes, vote_no, transfer_fund
+        r.skip(32 + 8 + 8 + 4 + 4 + 8 + 8 + 8);
+        for(uint32_t n = r.read_varuint(); n > 0; --n){
+            uint64_t a = r.read<uint64_t>();
+            aid_list.emplace_back(a, r.read<int64_t>());
+        }
+        found = true;
+    }
+    if(!found) throw runtime_error("case does not exist in cases2");
+
+    size_t position = aid_list.size();
+    for(size_t i = 0; i < aid_list.size(); ++i){
+        if(aid_list[i].first == account){
+            position = i;
+            break;
+        }
+    }
+    if(position == aid_list.size()) throw runtime_error("account did not contribute to this case");
+
+    //均摊列表的树直接由全部叶子构造，与merkle.hpp中的merkle_root相同
+    vector<hash256> level;
+    for(const auto& aid : aid_list) level.push_back(leaf(aid.first, aid.second));
+    hash256 h = level[position];
+    vector<proof_step> aid_path;
+    size_t index = position;
+    while(level.size() > 1){
+        size_t sibling = index ^ 1;
+        aid_path.push_back(proof_step{sibling < level.size() ? level[sibling] : zero_hash(), (index & 1) != 0});
+        vector<hash256> next;
+        for(size_t i = 0; i < level.size(); i += 2){
+            next.push_back(parent(level[i], i + 1 < level.size() ? level[i + 1] : zero_hash()));
+        }
+        level.swap(next);
+        index >>= 1;
+    }
+    hash256 aid_root = fold(h, aid_path);
+    hash256 cl = case_leaf(case_id, aid_root);
+    auto path = tree_path(st, CONTRIB_TREE, case_id);
+
+    printf("amount        %lld\n", (long long)aid_list[position].second);
+    printf("position      %zu of %zu\n", position, aid_list.size());
+    printf("leaf          %s\n", h.hex().c_str());
+    print_path("aid_sibling", aid_path);
+    printf("aid_root      %s\n", aid_root.hex().c_str());
+    printf("case_leaf     %s\n", cl.hex().c_str());
+    print_path("sibling", path);
+    return print_roots(st, CONTRIB_TREE, fold(cl, path), global_path);
+}
+
+static bool archived_proof(const merkle_state& st, const string& archive_path, uint64_t case_id, const string& global_path){
+    bool found = false;
+    uint64_t contributors = 0;
+    hash256 aid_root = zero_hash();
+    for(const auto& row : read_hex_rows(archive_path)){
+        row_reader r{row.data(), row.data() + row.size()};
+        if(r.read<uint64_t>() != case_id) continue;
+        //case_digest, proposer, required_fund, start_time, exec_time, vote_yes, vote_no, transfer_fund
+        r.skip(32 + 8 + 8 + 4 + 4 + 8 + 8 + 8);
+        contributors = r.read<uint64_t>();
+        aid_root = r.read_hash();
+        found = true;
+    }
+    if(!found) throw runtime_error("case does not exist in casearchive");
+
+    hash256 cl = case_leaf(case_id, aid_root);
+    auto path = tree_path(st, CONTRIB_TREE, case_id);
+    printf("contributors  %llu\n", (unsigned long long)contributors);
+    printf("aid_root      %s\n", aid_root.hex().c_str());
+    printf("case_leaf     %s\n", cl.hex().c_str());
+    print_path("sibling", path);
+    return print_roots(st, CONTRIB_TREE, fold(cl, path), global_path);
+}
+
+static int usage(){
+    cerr << "usage:" << endl
+         << "  mdsproof member  <merkletree.hex> <merklenode.hex> <merkleleaf.hex> <accounts.hex> <account> [global2.hex]" << endl
+         << "  mdsproof contrib <merkletree.hex> <merklenode.hex> <cases2.hex> <case_id> <account> [global2.hex]" << endl
+         << "  mdsproof archived <merkletree.hex> <merklenode.hex> <casearchive.hex> <case_id> [global2.hex]" << endl;
+    return 1;
+}
+
+int main(int argc, char** argv){
+    if(argc < 3) return usage();
+    string cmd = argv[1];
+    int args = cmd == "archived" ? 6 : 7;
+    if(argc < args || argc > args + 1) return usage();
+    string global_path = argc == args + 1 ? argv[args] : "";
+    try{
+        merkle_state st(argv[2], argv[3]);
+        bool ok;
+        if(cmd == "member"){
+            ok = member_proof(st, argv[4], argv[5], string_to_name(argv[6]), global_path);
+        }else if(cmd == "archived"){
+            ok = archived_proof(st, argv[4], strtoull(argv[5], nullptr, 10), global_path);
+        }else if(cmd == "contrib"){
+            ok = contrib_proof(st, argv[4], strtoull(argv[5], nullptr, 10), string_to_name(argv[6]), global_path);
+        }else{
+            return usage();
+        }
+        return ok ? 0 : 2;
+    }catch(const exception& e){
+        cerr << "error: " << e.what() << endl;
+        return 1;
+    }
+}
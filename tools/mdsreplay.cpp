@@ -0,0 +1,152 @@
+// mdsreplay: medishares action日志的确定性回放工具
+//
+// 将合约以原生方式编译（tools/native中的eosiolib替代实现），按记录的时间戳依次执行合约自身的action
+// 以及medisharesbp::transfer通知，输出每个action的表读写次数、字节数及耗时，用于离线复现主网上的CPU超限问题。
+//
+// 编译：g++ -std=c++17 -O2 -I. -Itools/native -o mdsreplay tools/mdsreplay.cpp tools/native/chain.cpp tools/native/rows.cpp medishares.cpp
+//
+// 日志格式，每行一个action，#开头的行为注释：
+//   <unix时间> <code> <action> <授权账户> <hex数据>
+// 例如由history接口的block_time、act.account、act.name、act.authorization[0].actor、act.hex_data组成。
+//
+// 用法：
+//   mdsreplay [--contract medishares] [--resume state.bin] [--checkpoint-every N] [--checkpoint-prefix ckpt] [--check-merkle] actions.log
+// 每执行N行保存一次状态检查点<prefix>-<行号>.bin，--resume从检查点记录的位置继续回放。
+// --check-merkle在每个action成功后由叶子重新计算Merkle树并与merkletree、global.merkle_root比对，不一致时返回非0，
+// tools/replay下的日志即按此方式用作回归检查。
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "native/chain.hpp"
+#include "native/rows.hpp"
+
+using namespace std;
+
+struct replay_record {
+    uint64_t line;
+    string   action;
+    double   wall_us;
+    native_chain::action_result result;
+};
+
+static bool parse_hex(const string& hex, vector<char>& out){
+    out.clear();
+    if(hex.size() % 2 != 0) return false;
+    for(size_t i = 0; i < hex.size(); i += 2){
+        char* end = nullptr;
+        string byte = hex.substr(i, 2);
+        long v = strtol(byte.c_str(), &end, 16);
+        if(*end != '\0') return false;
+        out.push_back(char(v));
+    }
+    return true;
+}
+
+static int usage(){
+    cerr << "usage: mdsreplay [--contract name] [--resume state.bin] [--checkpoint-every N] [--checkpoint-prefix prefix] [--check-merkle] actions.log" << endl;
+    return 1;
+}
+
+int main(int argc, char** argv){
+    string contract = "medishares";
+    string resume;
+    string checkpoint_prefix = "ckpt";
+    uint64_t checkpoint_every = 0;
+    bool check_merkle = false;
+    string log_path;
+
+    for(int i = 1; i < argc; ++i){
+        string arg = argv[i];
+        if(arg == "--contract" && i + 1 < argc) contract = argv[++i];
+        else if(arg == "--resume" && i + 1 < argc) resume = argv[++i];
+        else if(arg == "--checkpoint-every" && i + 1 < argc) checkpoint_every = strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--checkpoint-prefix" && i + 1 < argc) checkpoint_prefix = argv[++i];
+        else if(arg == "--check-merkle") check_merkle = true;
+        else if(log_path.empty() && arg[0] != '-') log_path = arg;
+        else return usage();
+    }
+    if(log_path.empty()) return usage();
+
+    ifstream in(log_path);
+    if(!in){
+        cerr << "can not open " << log_path << endl;
+        return 1;
+    }
+
+    uint64_t self = native_chain::string_to_name(contract.c_str());
+    uint64_t start = 0;
+    if(!resume.empty()){
+        try{
+            start = native_chain::load_state(resume);
+        }catch(const exception& e){
+            cerr << "error: " << e.what() << endl;
+            return 1;
+        }
+        cerr << "resumed from " << resume << " at line " << start << endl;
+    }
+
+    vector<replay_record> records;
+    uint64_t line_no = 0, failed = 0, inconsistent = 0;
+    string line;
+    cout << "line\ttime\taction\tresult\twall_us\treads\twrites\tbytes_read\tbytes_written\terror" << endl;
+    while(getline(in, line)){
+        line_no ++;
+        if(line_no <= start) continue;
+        if(line.empty() || line[0] == '#') continue;
+
+        istringstream fields(line);
+        uint64_t timestamp = 0;
+        string code, action, actor, hex;
+        fields >> timestamp >> code >> action >> actor >> hex;
+        vector<char> data;
+        if(!fields && !fields.eof()){
+            cerr << "line " << line_no << ": parse error" << endl;
+            return 1;
+        }
+        if(!parse_hex(hex, data)){
+            cerr << "line " << line_no << ": invalid hex data" << endl;
+            return 1;
+        }
+
+        native_chain::set_now(uint32_t(timestamp));
+        auto begin = chrono::steady_clock::now();
+        auto result = native_chain::push_action(self, native_chain::string_to_name(code.c_str()), native_chain::string_to_name(action.c_str()),
+                                                native_chain::string_to_name(actor.c_str()), data);
+        double wall_us = chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count();
+        if(!result.ok) failed ++;
+
+        printf("%llu\t%llu\t%s::%s\t%s\t%.1f\t%llu\t%llu\t%llu\t%llu\t%s\n",
+               (unsigned long long)line_no, (unsigned long long)timestamp, code.c_str(), action.c_str(), result.ok ? "ok" : "failed", wall_us,
+               (unsigned long long)result.stats.reads, (unsigned long long)result.stats.writes,
+               (unsigned long long)result.stats.bytes_read, (unsigned long long)result.stats.bytes_written, result.error.c_str());
+        records.push_back(replay_record{line_no, code + "::" + action, wall_us, result});
+
+        string error;
+        if(check_merkle && result.ok && !native_rows::check_merkle(self, error)){
+            cerr << "line " << line_no << ": " << error << endl;
+            inconsistent ++;
+        }
+
+        if(checkpoint_every > 0 && records.size() % checkpoint_every == 0){
+            native_chain::save_state(checkpoint_prefix + "-" + to_string(line_no) + ".bin", line_no);
+        }
+    }
+
+    //汇总：总数、失败数及耗时最长的action
+    sort(records.begin(), records.end(), [](const replay_record& a, const replay_record& b){ return a.wall_us > b.wall_us; });
+    cerr << records.size() << " actions replayed, " << failed << " failed" << endl;
+    if(check_merkle) cerr << inconsistent << " merkle inconsistencies" << endl;
+    for(size_t i = 0; i < records.size() && i < 10; ++i){
+        const auto& r = records[i];
+        fprintf(stderr, "  line %llu %s %.1f us, %llu reads, %llu writes\n", (unsigned long long)r.line, r.action.c_str(), r.wall_us,
+                (unsigned long long)r.result.stats.reads, (unsigned long long)r.result.stats.writes);
+    }
+    return inconsistent > 0 ? 2 : 0;
+}
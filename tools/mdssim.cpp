@@ -0,0 +1,390 @@
+// mdssim: 互助池偿付能力及参数调优的蒙特卡洛模拟工具
+//
+// 在原生编译的合约上运行随机的入池、申请互助、投票、执行划款及卖出KEY负载，合约逻辑（Bancor定价、
+// handleTransfer分割、execproposal均摊）与链上完全一致。每组参数独立运行多次，所有模拟任务由
+// 工作窃取线程池分发到全部CPU核心，输出保障池余额、每个受保用户的累计均摊额及KEY价格的分布。
+//
+// 编译：g++ -std=c++17 -O2 -pthread -Itools/native -o mdssim tools/mdssim.cpp tools/native/chain.cpp tools/native/rows.cpp medishares.cpp
+//
+// 用法：
+//   mdssim [--runs 100] [--days 365] [--members 200] [--threads 0] [--seed 1]
+//          [--guarantee-rate 600,700] [--ref-rate 50,100] [--max-claim 5000000]
+//          [--min-apply-interval 2592000] [--time-for-vote 259200]
+//          [--deposit-rate 2.0] [--claim-rate 0.05] [--sell-rate 0.5]
+// 参数取值可用逗号给出多个，按全部组合进行扫描；金额以EMDS最小单位（0.0001 EMDS）计，时间以秒计。
+// 结果以CSV输出到标准输出，每组参数一行。
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "native/chain.hpp"
+#include "native/rows.hpp"
+
+using namespace std;
+
+static constexpr uint64_t string_to_symbol(uint8_t precision, const char* str){
+    uint64_t result = 0;
+    for(uint32_t i = 0; str[i]; ++i){
+        result |= (uint64_t(str[i]) << (8 * (1 + i)));
+    }
+    return result | uint64_t(precision);
+}
+
+static constexpr uint64_t KEY_SYMBOL = string_to_symbol(0, "KEY");
+static constexpr uint64_t TOKEN_SYMBOL = string_to_symbol(4, "EMDS");
+static constexpr uint32_t DAY = 86400;
+
+struct params {
+    uint64_t guarantee_rate;
+    uint64_t ref_rate;
+    int64_t  max_claim;
+    uint32_t min_apply_interval;
+    uint32_t time_for_vote;
+};
+
+struct workload {
+    uint32_t days = 365;
+    uint32_t members = 200;
+    double   deposit_rate = 2.0;   //每天新入池或续费的次数（泊松均值）
+    double   claim_rate = 0.05;    //每天发起互助申请的次数（泊松均值）
+    double   sell_rate = 0.5;      //每天卖出KEY的次数（泊松均值）
+    int64_t  deposit_mean = 1000000;
+};
+
+struct run_result {
+    double guarantee_pool;
+    double member_levy;
+    double key_price;
+    double paid_cases;
+};
+
+//按合约action参数顺序打包
+class packer {
+  public:
+    packer& u64(uint64_t v){ return raw(&v, sizeof(v)); }
+    packer& u32(uint32_t v){ return raw(&v, sizeof(v)); }
+    packer& name(const string& n){ return u64(native_chain::string_to_name(n.c_str())); }
+    packer& asset(int64_t amount, uint64_t symbol){ raw(&amount, sizeof(amount)); return u64(symbol); }
+    packer& str(const string& s){
+        _data.push_back(char(s.size()));
+        _data.insert(_data.end(), s.begin(), s.end());
+        return *this;
+    }
+    packer& bytes(const void* p, size_t n){ return raw(p, n); }
+    const vector<char>& data()const { return _data; }
+
+  private:
+    packer& raw(const void* p, size_t n){
+        _data.insert(_data.end(), (const char*)p, (const char*)p + n);
+        return *this;
+    }
+    vector<char> _data;
+};
+
+//内联transfer的action数据：from, to, quantity
+template<typename T>
+static T read_at(const vector<char>& d, size_t offset){
+    T v;
+    memcpy(&v, d.data() + offset, sizeof(T));
+    return v;
+}
+
+struct global_view {
+    int64_t  guarantee_pool;
+    uint64_t cases_num;
+    uint64_t guaranteed_accounts;
+};
+
+static global_view read_global(uint64_t self){
+    native_rows::global_row g;
+    if(!native_rows::read_global(self, g)) throw runtime_error("global2 does not exist");
+    return global_view{ g.guarantee_pool, g.cases_num, g.guaranteed_accounts };
+}
+
+//两边权重相同，KEY价格为quote/base
+static double read_key_price(uint64_t self){
+    native_rows::keymarket_row k;
+    if(!native_rows::read_keymarket(self, k)) throw runtime_error("keymarket2 does not exist");
+    return k.base_balance > 0 ? (double)k.quote_balance / 10000.0 / k.base_balance : 0;
+}
+
+static string member_name(uint32_t i){
+    static const char* chars = "abcdefghijklmnopqrstuvwxyz12345";
+    string n = "member";
+    for(int k = 0; k < 5; ++k){
+        n.push_back(chars[i % 31]);
+        i /= 31;
+    }
+    return n;
+}
+
+static run_result simulate(const params& p, const workload& w, uint64_t seed){
+    native_chain::reset();
+    mt19937_64 rng(seed);
+    const string contract = "medishares";
+    uint64_t self = native_chain::string_to_name(contract.c_str());
+    uint32_t t = 1000000;
+
+    auto push = [&](const string& code, const string& action, const string& actor, const packer& data){
+        native_chain::set_now(t);
+        return native_chain::push_action(self, native_chain::string_to_name(code.c_str()), native_chain::string_to_name(action.c_str()),
+                                         native_chain::string_to_name(actor.c_str()), data.data());
+    };
+
+    const uint32_t observation = 30 * DAY;
+    push(contract, "init", contract, packer().u64(p.guarantee_rate).u64(p.ref_rate).asset(p.max_claim, TOKEN_SYMBOL)
+         .u32(observation).u32(30 * DAY).u32(p.min_apply_interval).u32(p.time_for_vote).str(string(46, 'Q')));
+
+    vector<string> members;
+    lognormal_distribution<double> deposit_size(log((double)w.deposit_mean), 0.8);
+    auto deposit = [&](size_t idx){
+        int64_t amount = max<int64_t>(100, (int64_t)deposit_size(rng));
+        push("medisharesbp", "transfer", members[idx], packer().name(members[idx]).name(contract).asset(amount, TOKEN_SYMBOL).str(""));
+    };
+
+    for(uint32_t i = 0; i < w.members; ++i){
+        members.push_back(member_name(i));
+        deposit(i);
+        t += 1;
+    }
+    //一半成员质押少量KEY用于投票
+    for(size_t i = 0; i < members.size(); i += 2){
+        push(contract, "stakekey", members[i], packer().name(members[i]).asset(1000, KEY_SYMBOL));
+    }
+
+    struct open_case { uint64_t id; uint32_t start; };
+    vector<open_case> cases;
+    double levy = 0;
+    uint64_t paid = 0;
+    uniform_int_distribution<size_t> pick(0, members.size() - 1);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    poisson_distribution<int> deposits(w.deposit_rate), claims(w.claim_rate), sells(w.sell_rate);
+
+    uint32_t start = t;
+    for(uint32_t day = 0; day < w.days; ++day){
+        t = start + day * DAY + observation;
+
+        for(int n = deposits(rng); n > 0; --n){
+            if(unit(rng) < 0.3){
+                members.push_back(member_name((uint32_t)members.size()));
+                deposit(members.size() - 1);
+                pick = uniform_int_distribution<size_t>(0, members.size() - 1);
+            }else{
+                deposit(pick(rng));
+            }
+        }
+
+        for(int n = claims(rng); n > 0; --n){
+            size_t idx = pick(rng);
+            int64_t required = (int64_t)(unit(rng) * p.max_claim) + 1;
+            uint8_t digest[32];
+            for(auto& b : digest) b = uint8_t(rng());
+            auto g = read_global(self);
+            auto r = push(contract, "propose", members[idx], packer().name(members[idx]).bytes(digest, sizeof(digest)).asset(required, TOKEN_SYMBOL));
+            if(!r.ok) continue;
+            cases.push_back(open_case{g.cases_num + 1, t});
+            //质押成员以80%的概率赞成
+            for(size_t v = 0; v < members.size() && v < w.members; v += 2){
+                const char* act = unit(rng) < 0.8 ? "approve" : "unapprove";
+                push(contract, act, members[v], packer().name(members[v]).u64(g.cases_num + 1));
+            }
+        }
+
+        //持有的KEY不足时卖出失败，视为该成员当天未卖出
+        for(int n = sells(rng); n > 0; --n){
+            size_t idx = pick(rng);
+            push(contract, "sellkey", members[idx], packer().name(members[idx]).asset(100, KEY_SYMBOL));
+        }
+
+        //投票期结束的申请执行划款
+        for(auto itr = cases.begin(); itr != cases.end(); ){
+            if(itr->start + p.time_for_vote >= t){
+                ++itr;
+                continue;
+            }
+            auto g = read_global(self);
+            auto r = push(contract, "execproposal", members[0], packer().name(members[0]).u64(itr->id));
+            if(r.ok){
+                for(const auto& sent : r.sent){
+                    int64_t amount = read_at<int64_t>(sent.data, 16);
+                    if(g.guaranteed_accounts > 0) levy += (double)amount / g.guaranteed_accounts;
+                }
+                paid ++;
+            }
+            push(contract, "delproposal", members[0], packer().name(members[0]).u64(itr->id));
+            itr = cases.erase(itr);
+        }
+    }
+
+    auto g = read_global(self);
+    return run_result{ g.guarantee_pool / 10000.0, levy / 10000.0, read_key_price(self), (double)paid };
+}
+
+//工作窃取线程池：每个工作线程从自己队列的尾部取任务，空闲时从其他线程队列的头部窃取
+class work_stealing_pool {
+  public:
+    explicit work_stealing_pool(size_t threads):_queues(threads){}
+
+    void submit(size_t worker, function<void()> task){
+        auto& q = _queues[worker % _queues.size()];
+        lock_guard<mutex> lock(q.m);
+        q.tasks.push_back(move(task));
+    }
+
+    void run(){
+        vector<thread> workers;
+        for(size_t i = 0; i < _queues.size(); ++i){
+            workers.emplace_back([this, i]{ work(i); });
+        }
+        for(auto& w : workers) w.join();
+    }
+
+  private:
+    struct queue {
+        mutex m;
+        deque<function<void()>> tasks;
+    };
+
+    bool pop(size_t i, function<void()>& task){
+        auto& q = _queues[i];
+        lock_guard<mutex> lock(q.m);
+        if(q.tasks.empty()) return false;
+        task = move(q.tasks.back());
+        q.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(size_t i, function<void()>& task){
+        for(size_t k = 1; k < _queues.size(); ++k){
+            auto& q = _queues[(i + k) % _queues.size()];
+            lock_guard<mutex> lock(q.m);
+            if(q.tasks.empty()) continue;
+            task = move(q.tasks.front());
+            q.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    //任务只在启动前提交，所有队列为空即可退出
+    void work(size_t i){
+        function<void()> task;
+        while(pop(i, task) || steal(i, task)){
+            task();
+        }
+    }
+
+    vector<queue> _queues;
+};
+
+template<typename T>
+static vector<T> parse_list(const string& s){
+    vector<T> out;
+    stringstream ss(s);
+    string item;
+    while(getline(ss, item, ',')){
+        out.push_back((T)strtoull(item.c_str(), nullptr, 10));
+    }
+    return out;
+}
+
+static double quantile(vector<double> v, double q){
+    if(v.empty()) return 0;
+    size_t k = (size_t)(q * (v.size() - 1));
+    nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+static int usage(){
+    cerr << "usage: mdssim [--runs N] [--days N] [--members N] [--threads N] [--seed N]" << endl
+         << "              [--guarantee-rate a,b] [--ref-rate a,b] [--max-claim a,b] [--min-apply-interval a,b] [--time-for-vote a,b]" << endl
+         << "              [--deposit-rate x] [--claim-rate x] [--sell-rate x]" << endl;
+    return 1;
+}
+
+int main(int argc, char** argv){
+    uint32_t runs = 100, threads = 0;
+    uint64_t seed = 1;
+    workload w;
+    vector<uint64_t> guarantee_rates{600}, ref_rates{100};
+    vector<int64_t> max_claims{5000000};
+    vector<uint32_t> min_apply_intervals{30 * DAY}, times_for_vote{3 * DAY};
+
+    for(int i = 1; i < argc; ++i){
+        string arg = argv[i];
+        if(i + 1 >= argc) return usage();
+        string value = argv[++i];
+        if(arg == "--runs") runs = strtoul(value.c_str(), nullptr, 10);
+        else if(arg == "--days") w.days = strtoul(value.c_str(), nullptr, 10);
+        else if(arg == "--members") w.members = strtoul(value.c_str(), nullptr, 10);
+        else if(arg == "--threads") threads = strtoul(value.c_str(), nullptr, 10);
+        else if(arg == "--seed") seed = strtoull(value.c_str(), nullptr, 10);
+        else if(arg == "--guarantee-rate") guarantee_rates = parse_list<uint64_t>(value);
+        else if(arg == "--ref-rate") ref_rates = parse_list<uint64_t>(value);
+        else if(arg == "--max-claim") max_claims = parse_list<int64_t>(value);
+        else if(arg == "--min-apply-interval") min_apply_intervals = parse_list<uint32_t>(value);
+        else if(arg == "--time-for-vote") times_for_vote = parse_list<uint32_t>(value);
+        else if(arg == "--deposit-rate") w.deposit_rate = strtod(value.c_str(), nullptr);
+        else if(arg == "--claim-rate") w.claim_rate = strtod(value.c_str(), nullptr);
+        else if(arg == "--sell-rate") w.sell_rate = strtod(value.c_str(), nullptr);
+        else return usage();
+    }
+    if(threads == 0) threads = max(1u, thread::hardware_concurrency());
+    if(w.members == 0 || runs == 0) return usage();
+
+    vector<params> sets;
+    for(auto g : guarantee_rates)
+        for(auto r : ref_rates)
+            for(auto m : max_claims)
+                for(auto a : min_apply_intervals)
+                    for(auto v : times_for_vote)
+                        sets.push_back(params{g, r, m, a, v});
+
+    vector<vector<run_result>> results(sets.size(), vector<run_result>(runs));
+    work_stealing_pool pool(threads);
+    atomic<uint64_t> done(0);
+    size_t next_worker = 0;
+    for(size_t s = 0; s < sets.size(); ++s){
+        for(uint32_t r = 0; r < runs; ++r){
+            pool.submit(next_worker++, [&, s, r]{
+                results[s][r] = simulate(sets[s], w, seed * 1000003 + s * 7919 + r);
+                done ++;
+            });
+        }
+    }
+    pool.run();
+
+    printf("guarantee_rate,ref_rate,max_claim,min_apply_interval,time_for_vote,runs,"
+           "pool_p5,pool_p50,pool_p95,levy_p5,levy_p50,levy_p95,key_price_p5,key_price_p50,key_price_p95,paid_cases_p50\n");
+    for(size_t s = 0; s < sets.size(); ++s){
+        vector<double> pool_v, levy_v, price_v, paid_v;
+        for(const auto& r : results[s]){
+            pool_v.push_back(r.guarantee_pool);
+            levy_v.push_back(r.member_levy);
+            price_v.push_back(r.key_price);
+            paid_v.push_back(r.paid_cases);
+        }
+        const auto& p = sets[s];
+        printf("%llu,%llu,%lld,%u,%u,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.6f,%.6f,%.6f,%.0f\n",
+               (unsigned long long)p.guarantee_rate, (unsigned long long)p.ref_rate, (long long)p.max_claim, p.min_apply_interval, p.time_for_vote, runs,
+               quantile(pool_v, 0.05), quantile(pool_v, 0.5), quantile(pool_v, 0.95),
+               quantile(levy_v, 0.05), quantile(levy_v, 0.5), quantile(levy_v, 0.95),
+               quantile(price_v, 0.05), quantile(price_v, 0.5), quantile(price_v, 0.95),
+               quantile(paid_v, 0.5));
+    }
+    cerr << done.load() << " runs completed on " << threads << " threads" << endl;
+    return 0;
+}
@@ -0,0 +1,218 @@
+// mdssize: medishares.wasm代码体积统计与预算检查工具
+//
+// 解析wasm二进制，输出各section大小以及每个函数体的字节数（按大小排序），函数名取自name section或导出表，
+// 两者都没有时可用--wast指定同一次编译生成的.wast按函数定义顺序取名，名字按C++符号还原。
+// 指定--budget时，文件总大小超过预算则返回非0，用于在构建后发现体积回退。
+//
+// 编译：g++ -std=c++17 -O2 -o mdssize tools/mdssize.cpp
+//
+// 用法：
+//   mdssize [--top N] [--budget bytes] [--wast medishares.wast] medishares.wasm
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const char* section_names[] = {
+    "custom", "type", "import", "function", "table", "memory", "global",
+    "export", "start", "element", "code", "data"
+};
+
+class wasm_reader {
+  public:
+    wasm_reader(const vector<uint8_t>& d, size_t pos, size_t end):_d(d), _pos(pos), _end(end){}
+
+    uint8_t byte(){
+        if(_pos >= _end) throw runtime_error("unexpected end of wasm");
+        return _d[_pos++];
+    }
+
+    uint64_t leb(){
+        uint64_t v = 0;
+        for(int shift = 0; ; shift += 7){
+            uint8_t b = byte();
+            v |= uint64_t(b & 0x7f) << shift;
+            if((b & 0x80) == 0) return v;
+        }
+    }
+
+    string str(){
+        size_t len = leb();
+        if(_pos + len > _end) throw runtime_error("string out of range");
+        string s((const char*)_d.data() + _pos, len);
+        _pos += len;
+        return s;
+    }
+
+    void skip(size_t n){
+        if(_pos + n > _end) throw runtime_error("skip out of range");
+        _pos += n;
+    }
+
+    size_t pos()const { return _pos; }
+    bool done()const { return _pos >= _end; }
+
+  private:
+    const vector<uint8_t>& _d;
+    size_t _pos;
+    size_t _end;
+};
+
+struct function_size {
+    uint64_t index;
+    uint64_t size;
+};
+
+static string demangle(const string& name){
+    int status = 0;
+    char* out = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+    if(status != 0 || out == nullptr) return name;
+    string s(out);
+    free(out);
+    return s;
+}
+
+static int usage(){
+    cerr << "usage: mdssize [--top N] [--budget bytes] [--wast medishares.wast] medishares.wasm" << endl;
+    return 1;
+}
+
+int main(int argc, char** argv){
+    size_t top = 30;
+    uint64_t budget = 0;
+    string path;
+    string wast_path;
+    for(int i = 1; i < argc; ++i){
+        string arg = argv[i];
+        if(arg == "--top" && i + 1 < argc) top = strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--budget" && i + 1 < argc) budget = strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--wast" && i + 1 < argc) wast_path = argv[++i];
+        else if(path.empty()) path = arg;
+        else return usage();
+    }
+    if(path.empty()) return usage();
+
+    try {
+        ifstream in(path, ios::binary);
+        if(!in) throw runtime_error("can not open " + path);
+        vector<uint8_t> d((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        if(d.size() < 8 || d[0] != 0 || d[1] != 'a' || d[2] != 's' || d[3] != 'm')
+            throw runtime_error(path + " is not a wasm module");
+
+        uint64_t imported_functions = 0;
+        map<uint64_t, string> names;
+        vector<function_size> functions;
+        vector<pair<string, uint64_t>> sections;
+
+        wasm_reader r(d, 8, d.size());
+        while(!r.done()){
+            uint8_t id = r.byte();
+            uint64_t len = r.leb();
+            size_t begin = r.pos();
+            wasm_reader s(d, begin, begin + len);
+            string label = id < sizeof(section_names) / sizeof(section_names[0]) ? section_names[id] : "unknown";
+
+            if(id == 0){
+                string custom = s.str();
+                label += ":" + custom;
+                if(custom == "name"){
+                    while(!s.done()){
+                        uint8_t sub = s.byte();
+                        uint64_t sub_len = s.leb();
+                        if(sub != 1){
+                            s.skip(sub_len);
+                            continue;
+                        }
+                        for(uint64_t n = s.leb(); n > 0; --n){
+                            uint64_t index = s.leb();
+                            names[index] = s.str();
+                        }
+                    }
+                }
+            }else if(id == 2){
+                for(uint64_t n = s.leb(); n > 0; --n){
+                    s.str();
+                    s.str();
+                    uint8_t kind = s.byte();
+                    if(kind == 0){ s.leb(); imported_functions ++; }
+                    else if(kind == 1){ s.byte(); uint8_t f = s.byte(); s.leb(); if(f & 1) s.leb(); }
+                    else if(kind == 2){ uint8_t f = s.byte(); s.leb(); if(f & 1) s.leb(); }
+                    else if(kind == 3){ s.byte(); s.byte(); }
+                    else throw runtime_error("unknown import kind");
+                }
+            }else if(id == 7){
+                for(uint64_t n = s.leb(); n > 0; --n){
+                    string name = s.str();
+                    uint8_t kind = s.byte();
+                    uint64_t index = s.leb();
+                    if(kind == 0 && names.find(index) == names.end()) names[index] = name;
+                }
+            }else if(id == 10){
+                uint64_t count = s.leb();
+                for(uint64_t n = 0; n < count; ++n){
+                    uint64_t body = s.leb();
+                    functions.push_back(function_size{imported_functions + n, body});
+                    s.skip(body);
+                }
+            }
+            sections.emplace_back(label, len);
+            r.skip(len);
+        }
+
+        //.wast中的函数按定义顺序排列，编号从导入函数之后开始
+        if(!wast_path.empty()){
+            ifstream wast(wast_path);
+            if(!wast) throw runtime_error("can not open " + wast_path);
+            uint64_t index = imported_functions;
+            for(string line; getline(wast, line); ){
+                size_t pos = line.find_first_not_of(' ');
+                if(pos == string::npos || line.compare(pos, 7, "(func $") != 0) continue;
+                size_t begin = pos + 7;
+                size_t end = line.find_first_of(" )", begin);
+                names.emplace(index ++, line.substr(begin, end - begin));
+            }
+        }
+
+        printf("%-24s %10s\n", "section", "bytes");
+        for(const auto& s : sections) printf("%-24s %10llu\n", s.first.c_str(), (unsigned long long)s.second);
+        printf("%-24s %10llu\n\n", "total", (unsigned long long)d.size());
+
+        uint64_t code_total = 0;
+        for(const auto& f : functions) code_total += f.size;
+        sort(functions.begin(), functions.end(), [](const function_size& a, const function_size& b){
+            return a.size > b.size;
+        });
+        printf("%llu functions, %llu bytes of code\n", (unsigned long long)functions.size(), (unsigned long long)code_total);
+        printf("%10s %6s  %s\n", "bytes", "%", "function");
+        for(size_t i = 0; i < functions.size() && i < top; ++i){
+            const auto& f = functions[i];
+            auto itr = names.find(f.index);
+            string name = itr == names.end() ? "$" + to_string(f.index) : demangle(itr->second);
+            printf("%10llu %6.2f  %s\n", (unsigned long long)f.size, 100.0 * f.size / code_total, name.c_str());
+        }
+
+        if(budget > 0){
+            if(d.size() > budget){
+                fprintf(stderr, "\n%s is %llu bytes, over the budget of %llu bytes\n", path.c_str(),
+                        (unsigned long long)d.size(), (unsigned long long)budget);
+                return 2;
+            }
+            printf("\nwithin budget: %llu / %llu bytes\n", (unsigned long long)d.size(), (unsigned long long)budget);
+        }
+    } catch(const exception& e){
+        cerr << "mdssize: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
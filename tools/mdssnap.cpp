@@ -0,0 +1,494 @@
+// mdssnap: medishares表数据离线解码与分析工具
+//
+// 将合约表的原始二进制行（cleos get table <contract> <scope> <table> -b 输出的rows，每行一个hex串）
+// 流式解码为列式文件，列式文件可直接mmap后做统计分析，不需要逐行经过JSON ABI序列化。
+//
+// 编译：g++ -std=c++17 -O2 -o mdssnap tools/mdssnap.cpp
+//
+// 用法：
+//   cleos get table medishares medishares accounts -b -l 100000 | jq -r '.rows[]' > accounts.hex
+//   mdssnap decode accounts accounts.hex accounts.col      （accounts分片时将各scope的行合并到同一个hex文件）
+//   mdssnap decode global2 global.hex global.col           （global、cases、keymarket为迁移前的旧表，输出相同的列）
+//   mdssnap reconcile global.col accounts.col
+//   mdssnap topvoters accounts.col [n]
+//   mdssnap contrib cases.col [case_id]
+//
+// 行格式与medishares.hpp中的EOSLIB_SERIALIZE及medishares.abi保持一致，表结构变化时需同步修改下面的decode_*函数。
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static constexpr uint64_t string_to_symbol(uint8_t precision, const char* str){
+    uint64_t result = 0;
+    for(uint32_t i = 0; str[i]; ++i){
+        result |= (uint64_t(str[i]) << (8 * (1 + i)));
+    }
+    return result | uint64_t(precision);
+}
+
+static constexpr uint64_t KEY_SYMBOL = string_to_symbol(0, "KEY");
+static constexpr uint64_t STAKE_SYMBOL = string_to_symbol(0, "SKEY");
+static constexpr uint64_t TOKEN_SYMBOL = string_to_symbol(4, "EMDS");
+
+static string name_to_string(uint64_t value){
+    static const char* charmap = ".12345abcdefghijklmnopqrstuvwxyz";
+    string str(13, '.');
+    uint64_t tmp = value;
+    for(uint32_t i = 0; i <= 12; ++i){
+        char c = charmap[tmp & (i == 0 ? 0x0f : 0x1f)];
+        str[12 - i] = c;
+        tmp >>= (i == 0 ? 4 : 5);
+    }
+    str.erase(str.find_last_not_of('.') + 1);
+    return str;
+}
+
+//按字节读取一行原始数据，不复制
+struct row_reader {
+    const uint8_t* pos;
+    const uint8_t* end;
+
+    void need(size_t n){
+        if((size_t)(end - pos) < n) throw runtime_error("row truncated");
+    }
+    template<typename T>
+    T read(){
+        need(sizeof(T));
+        T v;
+        memcpy(&v, pos, sizeof(T));
+        pos += sizeof(T);
+        return v;
+    }
+    uint32_t read_varuint(){
+        uint64_t v = 0;
+        uint8_t b = 0, by = 0;
+        do{
+            need(1);
+            b = *pos++;
+            v |= uint64_t(b & 0x7f) << by;
+            by += 7;
+        }while(b & 0x80);
+        return (uint32_t)v;
+    }
+    const uint8_t* skip(size_t n){
+        need(n);
+        auto p = pos;
+        pos += n;
+        return p;
+    }
+};
+
+//列式文件：文件头 + 列目录 + 按8字节对齐的列数据，各列为定长元素的连续数组
+static const char COL_MAGIC[8] = {'M','D','S','C','O','L','0','1'};
+
+struct col_header {
+    char     magic[8];
+    char     table[16];
+    uint64_t rows;
+    uint64_t columns;
+};
+
+struct col_entry {
+    char     name[24];
+    uint64_t elem_size;
+    uint64_t count;
+    uint64_t offset;
+};
+
+class col_writer {
+  public:
+    explicit col_writer(const string& table):_table(table){}
+
+    template<typename T>
+    void push(const string& column, const T& v){
+        auto& c = column_of(column, sizeof(T));
+        c.data.append((const char*)&v, sizeof(T));
+        c.count ++;
+    }
+
+    void push_bytes(const string& column, const uint8_t* p, size_t n){
+        auto& c = column_of(column, n);
+        c.data.append((const char*)p, n);
+        c.count ++;
+    }
+
+    void add_row(){ _rows ++; }
+
+    uint64_t rows()const{ return _rows; }
+
+    uint64_t count(const string& column)const{
+        auto itr = _columns.find(column);
+        return itr == _columns.end() ? 0 : itr->second.count;
+    }
+
+    void write(const string& path){
+        col_header h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, COL_MAGIC, sizeof(COL_MAGIC));
+        strncpy(h.table, _table.c_str(), sizeof(h.table) - 1);
+        h.rows = _rows;
+        h.columns = _order.size();
+
+        vector<col_entry> dir(_order.size());
+        uint64_t offset = sizeof(col_header) + sizeof(col_entry) * dir.size();
+        for(size_t i = 0; i < _order.size(); ++i){
+            const auto& c = _columns[_order[i]];
+            memset(&dir[i], 0, sizeof(col_entry));
+            strncpy(dir[i].name, _order[i].c_str(), sizeof(dir[i].name) - 1);
+            dir[i].elem_size = c.elem_size;
+            dir[i].count = c.count;
+            offset = (offset + 7) & ~uint64_t(7);
+            dir[i].offset = offset;
+            offset += c.data.size();
+        }
+
+        ofstream out(path, ios::binary | ios::trunc);
+        if(!out) throw runtime_error("can not open " + path);
+        out.write((const char*)&h, sizeof(h));
+        out.write((const char*)dir.data(), sizeof(col_entry) * dir.size());
+        uint64_t written = sizeof(col_header) + sizeof(col_entry) * dir.size();
+        for(size_t i = 0; i < _order.size(); ++i){
+            static const char zeros[8] = {0};
+            out.write(zeros, dir[i].offset - written);
+            const auto& data = _columns[_order[i]].data;
+            out.write(data.data(), data.size());
+            written = dir[i].offset + data.size();
+        }
+    }
+
+  private:
+    struct column {
+        uint64_t elem_size = 0;
+        uint64_t count = 0;
+        string   data;
+    };
+
+    column& column_of(const string& name, size_t elem_size){
+        auto itr = _columns.find(name);
+        if(itr == _columns.end()){
+            _order.push_back(name);
+            itr = _columns.emplace(name, column()).first;
+            itr->second.elem_size = elem_size;
+        }
+        if(itr->second.elem_size != elem_size) throw runtime_error("column size mismatch: " + name);
+        return itr->second;
+    }
+
+    string _table;
+    uint64_t _rows = 0;
+    vector<string> _order;
+    map<string, column> _columns;
+};
+
+class col_file {
+  public:
+    explicit col_file(const string& path){
+        int fd = open(path.c_str(), O_RDONLY);
+        if(fd < 0) throw runtime_error("can not open " + path);
+        struct stat st;
+        fstat(fd, &st);
+        _size = st.st_size;
+        _base = (const uint8_t*)mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if(_base == MAP_FAILED) throw runtime_error("mmap failed: " + path);
+        if(_size < sizeof(col_header) || memcmp(header().magic, COL_MAGIC, sizeof(COL_MAGIC)) != 0)
+            throw runtime_error("not a column file: " + path);
+    }
+    ~col_file(){ munmap((void*)_base, _size); }
+    col_file(const col_file&) = delete;
+    col_file& operator=(const col_file&) = delete;
+
+    const col_header& header()const{ return *(const col_header*)_base; }
+    string table()const{ return string(header().table); }
+    uint64_t rows()const{ return header().rows; }
+
+    //返回列数据指针，列不存在时count为0
+    template<typename T>
+    const T* column(const string& name, uint64_t& count)const{
+        auto dir = (const col_entry*)(_base + sizeof(col_header));
+        for(uint64_t i = 0; i < header().columns; ++i){
+            if(name == dir[i].name){
+                if(dir[i].elem_size != sizeof(T)) throw runtime_error("column type mismatch: " + name);
+                count = dir[i].count;
+                return (const T*)(_base + dir[i].offset);
+            }
+        }
+        count = 0;
+        return nullptr;
+    }
+
+  private:
+    const uint8_t* _base = nullptr;
+    size_t _size = 0;
+};
+
+static void decode_asset(row_reader& r, col_writer& w, const string& column){
+    w.push(column, r.read<int64_t>());
+    r.read<uint64_t>();
+}
+
+//global2、cases2、keymarket2中符号固定的资产字段只存金额，解码迁移前的旧表时按完整asset读取
+static bool legacy_layout = false;
+
+static void decode_amount(row_reader& r, col_writer& w, const string& column){
+    if(legacy_layout){
+        decode_asset(r, w, column);
+    }else{
+        w.push(column, r.read<int64_t>());
+    }
+}
+
+static void decode_accounts(row_reader& r, col_writer& w){
+    w.push("account", r.read<uint64_t>());
+    w.push("join_time", r.read<uint32_t>());
+    w.push("latest_apply_time", r.read<uint32_t>());
+
+    //asset_list按符号展开为三列
+    int64_t balance[3] = {0, 0, 0};
+    for(uint32_t n = r.read_varuint(); n > 0; --n){
+        int64_t amount = r.read<int64_t>();
+        uint64_t symbol = r.read<uint64_t>();
+        if(symbol == TOKEN_SYMBOL) balance[0] = amount;
+        else if(symbol == KEY_SYMBOL) balance[1] = amount;
+        else if(symbol == STAKE_SYMBOL) balance[2] = amount;
+    }
+    w.push("emds", balance[0]);
+    w.push("key", balance[1]);
+    w.push("skey", balance[2]);
+
+    //vote_list展开为扁平列，vote_begin记录每行在扁平列中的起始位置
+    w.push("vote_begin", w.count("vote_case"));
+    for(uint32_t n = r.read_varuint(); n > 0; --n){
+        w.push("vote_case", r.read<uint64_t>());
+        w.push("vote_agreed", r.read<uint8_t>());
+    }
+    //加入ram_payer之前写入的行没有该字段
+    w.push("ram_payer", r.pos < r.end ? r.read<uint64_t>() : uint64_t(0));
+}
+
+static void decode_cases(row_reader& r, col_writer& w){
+    w.push("case_id", r.read<uint64_t>());
+    w.push_bytes("case_digest", r.skip(32), 32);
+    w.push("proposer", r.read<uint64_t>());
+    decode_amount(r, w, "required_fund");
+    w.push("start_time", r.read<uint32_t>());
+    w.push("exec_time", r.read<uint32_t>());
+    decode_amount(r, w, "vote_yes");
+    decode_amount(r, w, "vote_no");
+    decode_amount(r, w, "transfer_fund");
+
+    w.push("aid_begin", w.count("aid_account"));
+    for(uint32_t n = r.read_varuint(); n > 0; --n){
+        w.push("aid_account", r.read<uint64_t>());
+        decode_amount(r, w, "aid_amount");
+    }
+}
+
+static void decode_casearchive(row_reader& r, col_writer& w){
+    w.push("case_id", r.read<uint64_t>());
+    w.push_bytes("case_digest", r.skip(32), 32);
+    w.push("proposer", r.read<uint64_t>());
+    decode_amount(r, w, "required_fund");
+    w.push("start_time", r.read<uint32_t>());
+    w.push("exec_time", r.read<uint32_t>());
+    decode_amount(r, w, "vote_yes");
+    decode_amount(r, w, "vote_no");
+    decode_amount(r, w, "transfer_fund");
+    w.push("contributors", r.read<uint64_t>());
+    w.push_bytes("aid_root", r.skip(32), 32);
+}
+
+static void decode_global(row_reader& r, col_writer& w){
+    w.push("ref_rate", r.read<uint64_t>());
+    w.push("guarantee_rate", r.read<uint64_t>());
+    decode_amount(r, w, "guarantee_pool");
+    decode_amount(r, w, "bonus_pool");
+    w.push("cases_num", r.read<uint64_t>());
+    w.push("applied_cases", r.read<uint64_t>());
+    w.push("guaranteed_accounts", r.read<uint64_t>());
+    decode_amount(r, w, "max_claim");
+    w.push("min_apply_interval", r.read<uint32_t>());
+    w.push("time_for_vote", r.read<uint32_t>());
+    w.push("time_for_observation", r.read<uint32_t>());
+    w.push("time_for_announcement", r.read<uint32_t>());
+    decode_amount(r, w, "total_key");
+    decode_amount(r, w, "total_skey");
+    decode_amount(r, w, "total_donate");
+    uint8_t rule_hash[64] = {0};
+    uint32_t len = r.read_varuint();
+    memcpy(rule_hash, r.skip(len), min<uint32_t>(len, sizeof(rule_hash)));
+    w.push_bytes("rule_hash", rule_hash, sizeof(rule_hash));
+    uint8_t merkle_root[32] = {0};
+    if(!legacy_layout) memcpy(merkle_root, r.skip(32), sizeof(merkle_root));
+    w.push_bytes("merkle_root", merkle_root, sizeof(merkle_root));
+    w.push("shards", legacy_layout ? 0 : r.read<uint64_t>());
+}
+
+static void decode_keymarket(row_reader& r, col_writer& w){
+    decode_amount(r, w, "supply");
+    decode_amount(r, w, "base_balance");
+    if(legacy_layout) r.read<double>();
+    decode_amount(r, w, "quote_balance");
+    if(legacy_layout) r.read<double>();
+}
+
+typedef void (*decoder)(row_reader&, col_writer&);
+
+static decoder decoder_of(const string& table){
+    if(table == "accounts") return decode_accounts;
+    legacy_layout = table == "cases" || table == "global" || table == "keymarket";
+    if(table == "cases2" || table == "cases") return decode_cases;
+    if(table == "casearchive") return decode_casearchive;
+    if(table == "global2" || table == "global") return decode_global;
+    if(table == "keymarket2" || table == "keymarket") return decode_keymarket;
+    throw runtime_error("unsupported table: " + table);
+}
+
+static int hex_value(char c){
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static void decode(const string& table, const string& input, const string& output){
+    auto dec = decoder_of(table);
+    ifstream in(input);
+    if(!in) throw runtime_error("can not open " + input);
+
+    col_writer w(table);
+    string line;
+    vector<uint8_t> row;
+    while(getline(in, line)){
+        row.clear();
+        int hi = -1;
+        for(char c : line){
+            int v = hex_value(c);
+            if(v < 0) continue;
+            if(hi < 0){
+                hi = v;
+            }else{
+                row.push_back(uint8_t(hi << 4 | v));
+                hi = -1;
+            }
+        }
+        if(row.empty()) continue;
+        row_reader r{row.data(), row.data() + row.size()};
+        dec(r, w);
+        w.add_row();
+    }
+    w.write(output);
+    cout << table << ": " << w.rows() << " rows decoded to " << output << endl;
+}
+
+//保障池对账：accounts中所有EMDS保障余额之和应等于global.guarantee_pool
+static void reconcile(const string& global_path, const string& accounts_path){
+    col_file glb(global_path), acc(accounts_path);
+    uint64_t n = 0, m = 0;
+    auto pool = glb.column<int64_t>("guarantee_pool", n);
+    auto members = glb.column<uint64_t>("guaranteed_accounts", m);
+    if(n == 0 || m == 0) throw runtime_error("global row missing");
+
+    auto emds = acc.column<int64_t>("emds", n);
+    auto join = acc.column<uint32_t>("join_time", m);
+    int64_t total = 0;
+    uint64_t guaranteed = 0;
+    for(uint64_t i = 0; i < n; ++i){
+        total += emds[i];
+        if(join[i] > 0) guaranteed ++;
+    }
+    cout << "guarantee_pool      " << pool[0] << endl;
+    cout << "sum of balances     " << total << endl;
+    cout << "difference          " << pool[0] - total << endl;
+    cout << "guaranteed_accounts " << members[0] << endl;
+    cout << "accounts joined     " << guaranteed << endl;
+}
+
+static void topvoters(const string& accounts_path, size_t top){
+    col_file acc(accounts_path);
+    uint64_t n = 0, v = 0;
+    auto account = acc.column<uint64_t>("account", n);
+    auto skey = acc.column<int64_t>("skey", n);
+    auto vote_begin = acc.column<uint64_t>("vote_begin", n);
+    acc.column<uint64_t>("vote_case", v);
+
+    vector<uint64_t> idx(n);
+    for(uint64_t i = 0; i < n; ++i) idx[i] = i;
+    top = min<size_t>(top, n);
+    partial_sort(idx.begin(), idx.begin() + top, idx.end(), [&](uint64_t a, uint64_t b){ return skey[a] > skey[b]; });
+    for(size_t i = 0; i < top; ++i){
+        auto r = idx[i];
+        uint64_t votes = (r + 1 < n ? vote_begin[r + 1] : v) - vote_begin[r];
+        printf("%-13s %20lld SKEY %8llu votes\n", name_to_string(account[r]).c_str(), (long long)skey[r], (unsigned long long)votes);
+    }
+}
+
+static void contrib(const string& cases_path, bool one_case, uint64_t case_id){
+    col_file cas(cases_path);
+    uint64_t n = 0, a = 0;
+    auto id = cas.column<uint64_t>("case_id", n);
+    auto proposer = cas.column<uint64_t>("proposer", n);
+    auto transfer = cas.column<int64_t>("transfer_fund", n);
+    auto aid_begin = cas.column<uint64_t>("aid_begin", n);
+    auto aid_account = cas.column<uint64_t>("aid_account", a);
+    auto aid_amount = cas.column<int64_t>("aid_amount", a);
+
+    for(uint64_t i = 0; i < n; ++i){
+        if(one_case && id[i] != case_id) continue;
+        uint64_t end = i + 1 < n ? aid_begin[i + 1] : a;
+        int64_t total = 0;
+        for(uint64_t j = aid_begin[i]; j < end; ++j){
+            total += aid_amount[j];
+            if(one_case) printf("  %-13s %20lld\n", name_to_string(aid_account[j]).c_str(), (long long)aid_amount[j]);
+        }
+        printf("case %llu proposer %s contributors %llu contributed %lld transfer_fund %lld\n",
+               (unsigned long long)id[i], name_to_string(proposer[i]).c_str(), (unsigned long long)(end - aid_begin[i]),
+               (long long)total, (long long)transfer[i]);
+    }
+}
+
+static int usage(){
+    cerr << "usage:" << endl
+         << "  mdssnap decode <accounts|cases2|casearchive|global2|keymarket2> <rows.hex> <out.col>" << endl
+         << "  mdssnap reconcile <global.col> <accounts.col>" << endl
+         << "  mdssnap topvoters <accounts.col> [n]" << endl
+         << "  mdssnap contrib <cases.col> [case_id]" << endl;
+    return 1;
+}
+
+int main(int argc, char** argv){
+    if(argc < 3) return usage();
+    string cmd = argv[1];
+    try{
+        if(cmd == "decode" && argc == 5){
+            decode(argv[2], argv[3], argv[4]);
+        }else if(cmd == "reconcile" && argc == 4){
+            reconcile(argv[2], argv[3]);
+        }else if(cmd == "topvoters"){
+            topvoters(argv[2], argc > 3 ? strtoull(argv[3], nullptr, 10) : 20);
+        }else if(cmd == "contrib"){
+            contrib(argv[2], argc > 3, argc > 3 ? strtoull(argv[3], nullptr, 10) : 0);
+        }else{
+            return usage();
+        }
+    }catch(const exception& e){
+        cerr << "error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
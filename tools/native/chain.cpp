@@ -0,0 +1,273 @@
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <eosiolib/eosio.hpp>
+#include "chain.hpp"
+#include "sha256.hpp"
+
+extern "C" void apply(uint64_t receiver, uint64_t code, uint64_t action);
+
+namespace {
+
+typedef std::tuple<uint64_t, uint64_t, uint64_t, uint64_t> row_key;  // code, scope, table, id
+
+struct row {
+    account_name      payer;
+    std::vector<char> data;
+};
+
+struct undo_entry {
+    row_key key;
+    bool    existed;
+    row     old;
+};
+
+struct chain_state {
+    uint32_t                   now = 0;
+    std::map<row_key, row>     rows;
+    std::vector<undo_entry>    undo;
+    native_chain::db_stats     stats;
+    std::vector<char>          action_data;
+    account_name               receiver = 0;
+    account_name               actor = 0;
+    std::vector<eosio::action> inlines;
+};
+
+//每个线程拥有独立的链状态，mdssim在多个线程中并行运行互不相关的模拟
+chain_state& state(){
+    static thread_local chain_state s;
+    return s;
+}
+
+void record_undo(const row_key& key){
+    auto& s = state();
+    auto itr = s.rows.find(key);
+    if(itr == s.rows.end())
+        s.undo.push_back(undo_entry{key, false, row()});
+    else
+        s.undo.push_back(undo_entry{key, true, itr->second});
+}
+
+void rollback(){
+    auto& s = state();
+    for(auto itr = s.undo.rbegin(); itr != s.undo.rend(); ++itr){
+        if(itr->existed)
+            s.rows[itr->key] = itr->old;
+        else
+            s.rows.erase(itr->key);
+    }
+    s.undo.clear();
+}
+
+}
+
+uint32_t now(){ return state().now; }
+
+bool has_auth(account_name name){
+    return name == state().actor;
+}
+
+void require_auth(account_name name){
+    eosio_assert(has_auth(name), (std::string("missing authority of ") + name_to_string(name)).c_str());
+}
+
+void require_recipient(account_name){}
+
+bool is_account(account_name){ return true; }
+
+void prints(const char* cstr){ fputs(cstr, stdout); }
+
+void sha256(const char* data, uint32_t length, checksum256* hash){ native_sha256::digest(data, length, hash->hash); }
+
+namespace eosio { namespace native {
+
+bool db_get(uint64_t code, uint64_t scope, uint64_t table, uint64_t id, std::vector<char>& data){
+    auto& s = state();
+    auto itr = s.rows.find(row_key(code, scope, table, id));
+    s.stats.reads ++;
+    if(itr == s.rows.end())
+        return false;
+    data = itr->second.data;
+    s.stats.bytes_read += data.size();
+    return true;
+}
+
+bool db_lowerbound(uint64_t code, uint64_t scope, uint64_t table, uint64_t id, uint64_t& found, std::vector<char>& data){
+    auto& s = state();
+    auto itr = s.rows.lower_bound(row_key(code, scope, table, id));
+    s.stats.reads ++;
+    if(itr == s.rows.end() || std::get<0>(itr->first) != code || std::get<1>(itr->first) != scope || std::get<2>(itr->first) != table)
+        return false;
+    found = std::get<3>(itr->first);
+    data = itr->second.data;
+    s.stats.bytes_read += data.size();
+    return true;
+}
+
+void db_store(uint64_t code, uint64_t scope, uint64_t table, account_name payer, uint64_t id, const std::vector<char>& data){
+    auto& s = state();
+    eosio_assert(code == s.receiver, "db access violation");
+    row_key key(code, scope, table, id);
+    record_undo(key);
+    s.rows[key] = row{payer, data};
+    s.stats.writes ++;
+    s.stats.bytes_written += data.size();
+}
+
+void db_update(uint64_t code, uint64_t scope, uint64_t table, account_name payer, uint64_t id, const std::vector<char>& data){
+    auto& s = state();
+    eosio_assert(code == s.receiver, "db access violation");
+    row_key key(code, scope, table, id);
+    auto itr = s.rows.find(key);
+    eosio_assert(itr != s.rows.end(), "db_update of missing row");
+    record_undo(key);
+    itr->second.data = data;
+    if(payer != 0)
+        itr->second.payer = payer;
+    s.stats.writes ++;
+    s.stats.bytes_written += data.size();
+}
+
+void db_remove(uint64_t code, uint64_t scope, uint64_t table, uint64_t id){
+    auto& s = state();
+    eosio_assert(code == s.receiver, "db access violation");
+    row_key key(code, scope, table, id);
+    record_undo(key);
+    s.rows.erase(key);
+    s.stats.writes ++;
+}
+
+void send_inline(account_name account, action_name name, const std::vector<permission_level>& authorization, const std::vector<char>& data){
+    eosio::action act(permission_level(), 0, 0, std::make_tuple());
+    act.account = account;
+    act.name = name;
+    act.authorization = authorization;
+    act.data = data;
+    state().inlines.push_back(act);
+}
+
+const std::vector<char>& current_action_data(){
+    return state().action_data;
+}
+
+} }
+
+namespace native_chain {
+
+void reset(){ state() = chain_state(); }
+
+void set_now(uint32_t seconds){ state().now = seconds; }
+
+uint32_t get_now(){ return state().now; }
+
+action_result push_action(uint64_t receiver, uint64_t code, uint64_t action, uint64_t actor, const std::vector<char>& data){
+    auto& s = state();
+    action_result result;
+    s.undo.clear();
+    s.stats = db_stats();
+    s.inlines.clear();
+    s.receiver = receiver;
+
+    std::vector<eosio::action> pending;
+    pending.push_back(eosio::action(eosio::permission_level(actor, N(active)), code, action, std::make_tuple()));
+    pending.back().data = data;
+    size_t next = 0;
+    try{
+        for(; next < pending.size(); ++next){
+            const auto& act = pending[next];
+            s.action_data = act.data;
+            s.actor = act.authorization.empty() ? 0 : act.authorization[0].actor;
+            apply(receiver, act.account, act.name);
+            for(auto& sent : s.inlines){
+                if(sent.account == receiver){
+                    pending.push_back(sent);
+                }else{
+                    result.sent.push_back(sent_action{sent.account, sent.name, sent.authorization.empty() ? 0 : sent.authorization[0].actor, sent.data});
+                }
+            }
+            s.inlines.clear();
+        }
+    }catch(const std::exception& e){
+        rollback();
+        result.ok = false;
+        result.error = e.what();
+        result.sent.clear();
+    }
+    s.undo.clear();
+    s.inlines.clear();
+    result.stats = s.stats;
+    return result;
+}
+
+static const char STATE_MAGIC[8] = {'M','D','S','S','T','A','T','E'};
+
+//状态文件使用stdio读写，原生eosiolib中的time类型与<ctime>中的time()同名，不能引入iostream
+template<typename T>
+static void write_pod(FILE* out, const T& v){ fwrite(&v, sizeof(v), 1, out); }
+
+template<typename T>
+static T read_pod(FILE* in){
+    T v;
+    eosio_assert(fread(&v, sizeof(v), 1, in) == 1, "truncated state file");
+    return v;
+}
+
+void save_state(const std::string& path, uint64_t position){
+    auto& s = state();
+    FILE* out = fopen(path.c_str(), "wb");
+    eosio_assert(out != nullptr, "can not write state file");
+    fwrite(STATE_MAGIC, sizeof(STATE_MAGIC), 1, out);
+    write_pod(out, position);
+    write_pod(out, s.now);
+    write_pod(out, uint64_t(s.rows.size()));
+    for(const auto& r : s.rows){
+        write_pod(out, std::get<0>(r.first));
+        write_pod(out, std::get<1>(r.first));
+        write_pod(out, std::get<2>(r.first));
+        write_pod(out, std::get<3>(r.first));
+        write_pod(out, r.second.payer);
+        write_pod(out, uint32_t(r.second.data.size()));
+        fwrite(r.second.data.data(), 1, r.second.data.size(), out);
+    }
+    fclose(out);
+}
+
+uint64_t load_state(const std::string& path){
+    auto& s = state();
+    FILE* in = fopen(path.c_str(), "rb");
+    eosio_assert(in != nullptr, "can not read state file");
+    char magic[sizeof(STATE_MAGIC)];
+    eosio_assert(fread(magic, sizeof(magic), 1, in) == 1 && memcmp(magic, STATE_MAGIC, sizeof(magic)) == 0, "not a state file");
+    auto position = read_pod<uint64_t>(in);
+    s.now = read_pod<uint32_t>(in);
+    s.rows.clear();
+    for(auto n = read_pod<uint64_t>(in); n > 0; --n){
+        auto code = read_pod<uint64_t>(in);
+        auto scope = read_pod<uint64_t>(in);
+        auto table = read_pod<uint64_t>(in);
+        auto id = read_pod<uint64_t>(in);
+        row r;
+        r.payer = read_pod<uint64_t>(in);
+        r.data.resize(read_pod<uint32_t>(in));
+        eosio_assert(fread(r.data.data(), 1, r.data.size(), in) == r.data.size(), "truncated state file");
+        s.rows.emplace(row_key(code, scope, table, id), std::move(r));
+    }
+    fclose(in);
+    return position;
+}
+
+void for_each_row(uint64_t code, uint64_t scope, uint64_t table, void (*visit)(uint64_t id, const std::vector<char>& data, void* ctx), void* ctx){
+    auto& s = state();
+    for(auto itr = s.rows.lower_bound(row_key(code, scope, table, 0)); itr != s.rows.end(); ++itr){
+        if(std::get<0>(itr->first) != code || std::get<1>(itr->first) != scope || std::get<2>(itr->first) != table)
+            break;
+        visit(std::get<3>(itr->first), itr->second.data, ctx);
+    }
+}
+
+uint64_t string_to_name(const char* str){ return ::string_to_name(str); }
+
+std::string name_to_string(uint64_t name){ return ::name_to_string(name); }
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//合约原生运行环境的驱动接口：提供可控的now()、表存储、交易回滚、内联action及状态检查点。
+//本头文件不依赖eosiolib，供mdsreplay等工具的主程序使用。
+namespace native_chain {
+
+struct db_stats {
+    uint64_t reads = 0;          //按主键查找及遍历读取的行数
+    uint64_t writes = 0;         //新增、修改、删除的行数
+    uint64_t bytes_read = 0;
+    uint64_t bytes_written = 0;
+};
+
+struct sent_action {
+    uint64_t          account;
+    uint64_t          name;
+    uint64_t          actor;
+    std::vector<char> data;
+};
+
+struct action_result {
+    bool                     ok = true;
+    std::string              error;
+    db_stats                 stats;
+    std::vector<sent_action> sent;    //发往其他合约的内联action（如代币转账），不在本地执行
+};
+
+//清空当前线程的全部表数据
+void reset();
+
+void set_now(uint32_t seconds);
+uint32_t get_now();
+
+//以actor的授权执行一笔只包含该action的交易，receiver为合约账户。
+//发给receiver自身的内联action在同一交易内依次执行，任一失败则整笔交易回滚。
+action_result push_action(uint64_t receiver, uint64_t code, uint64_t action, uint64_t actor, const std::vector<char>& data);
+
+//状态检查点：保存全部表数据及调用方给出的回放位置
+void save_state(const std::string& path, uint64_t position);
+uint64_t load_state(const std::string& path);
+
+//遍历receiver合约某张表在指定scope中的全部行
+void for_each_row(uint64_t code, uint64_t scope, uint64_t table, void (*visit)(uint64_t id, const std::vector<char>& data, void* ctx), void* ctx);
+
+uint64_t string_to_name(const char* str);
+std::string name_to_string(uint64_t name);
+
+}
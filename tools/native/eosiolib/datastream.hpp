@@ -0,0 +1,254 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <boost/preprocessor/seq/for_each.hpp>
+#include "system.hpp"
+#include "varint.hpp"
+
+namespace eosio {
+
+template<typename T>
+class datastream;
+
+template<>
+class datastream<char*> {
+  public:
+    datastream(char* start, size_t size):_start(start), _pos(start), _end(start + size){}
+
+    bool write(const char* d, size_t n){
+        eosio_assert(size_t(_end - _pos) >= n, "write");
+        memcpy(_pos, d, n);
+        _pos += n;
+        return true;
+    }
+    bool read(char* d, size_t n){
+        eosio_assert(size_t(_end - _pos) >= n, "read");
+        memcpy(d, _pos, n);
+        _pos += n;
+        return true;
+    }
+    size_t tellp()const { return _pos - _start; }
+    size_t remaining()const { return _end - _pos; }
+
+  private:
+    char* _start;
+    char* _pos;
+    char* _end;
+};
+
+template<>
+class datastream<size_t> {
+  public:
+    datastream(size_t init = 0):_size(init){}
+    bool write(const char*, size_t n){ _size += n; return true; }
+    size_t tellp()const { return _size; }
+
+  private:
+    size_t _size;
+};
+
+template<typename DataStream, typename T, std::enable_if_t<std::is_arithmetic<T>::value, int> = 0>
+DataStream& operator << (DataStream& ds, const T& v){
+    ds.write((const char*)&v, sizeof(v));
+    return ds;
+}
+
+template<typename DataStream, typename T, std::enable_if_t<std::is_arithmetic<T>::value, int> = 0>
+DataStream& operator >> (DataStream& ds, T& v){
+    ds.read((char*)&v, sizeof(v));
+    return ds;
+}
+
+template<typename DataStream>
+DataStream& operator << (DataStream& ds, const unsigned_int& v){
+    uint64_t val = v.value;
+    do{
+        uint8_t b = uint8_t(val) & 0x7f;
+        val >>= 7;
+        b |= ((val > 0) << 7);
+        ds.write((const char*)&b, 1);
+    }while(val);
+    return ds;
+}
+
+template<typename DataStream>
+DataStream& operator >> (DataStream& ds, unsigned_int& vi){
+    uint64_t v = 0;
+    char b = 0;
+    uint8_t by = 0;
+    do{
+        ds.read(&b, 1);
+        v |= uint32_t(uint8_t(b) & 0x7f) << by;
+        by += 7;
+    }while(uint8_t(b) & 0x80);
+    vi.value = uint32_t(v);
+    return ds;
+}
+
+template<typename DataStream>
+DataStream& operator << (DataStream& ds, const std::string& v){
+    ds << unsigned_int(v.size());
+    if(v.size())
+        ds.write(v.data(), v.size());
+    return ds;
+}
+
+template<typename DataStream>
+DataStream& operator >> (DataStream& ds, std::string& v){
+    unsigned_int s;
+    ds >> s;
+    v.resize(s.value);
+    if(s.value)
+        ds.read(&v[0], s.value);
+    return ds;
+}
+
+template<typename DataStream, typename T>
+DataStream& operator << (DataStream& ds, const std::vector<T>& v){
+    ds << unsigned_int(v.size());
+    for(const auto& i : v)
+        ds << i;
+    return ds;
+}
+
+template<typename DataStream, typename T>
+DataStream& operator >> (DataStream& ds, std::vector<T>& v){
+    unsigned_int s;
+    ds >> s;
+    v.resize(s.value);
+    for(auto& i : v)
+        ds >> i;
+    return ds;
+}
+
+template<typename DataStream, typename... T>
+DataStream& operator << (DataStream& ds, const std::tuple<T...>& t){
+    std::apply([&](const auto&... a){ (void)std::initializer_list<int>{ (ds << a, 0)... }; }, t);
+    return ds;
+}
+
+template<typename DataStream, typename... T>
+DataStream& operator >> (DataStream& ds, std::tuple<T...>& t){
+    std::apply([&](auto&... a){ (void)std::initializer_list<int>{ (ds >> a, 0)... }; }, t);
+    return ds;
+}
+
+//未使用EOSLIB_SERIALIZE的聚合类型按成员顺序序列化（wasm版eosiolib中由boost::pfr完成）
+namespace detail {
+    struct any_field {
+        template<typename T>
+        operator T()const;
+    };
+
+    template<typename T, typename Seq, typename = void>
+    struct is_brace_constructible : std::false_type {};
+
+    template<typename T, size_t... I>
+    struct is_brace_constructible<T, std::index_sequence<I...>, std::void_t<decltype(T{ (I, any_field{})... })>> : std::true_type {};
+
+    template<typename T, size_t N = 4>
+    constexpr size_t field_count(){
+        if constexpr(N == 0)
+            return 0;
+        else if constexpr(is_brace_constructible<T, std::make_index_sequence<N>>::value)
+            return N;
+        else
+            return field_count<T, N - 1>();
+    }
+
+    template<typename T, typename = void>
+    struct has_eosio_serialize : std::false_type {};
+
+    template<typename T>
+    struct has_eosio_serialize<T, std::void_t<decltype(T::eosio_serialized)>> : std::true_type {};
+
+    template<typename T>
+    using reflected_aggregate = std::enable_if_t<std::is_class<T>::value && std::is_aggregate<T>::value && !has_eosio_serialize<T>::value, int>;
+
+    template<typename T, typename F>
+    void for_each_field(T& t, F&& f){
+        constexpr size_t n = field_count<std::remove_const_t<T>>();
+        static_assert(n >= 1 && n <= 4, "unsupported aggregate");
+        if constexpr(n == 1){ auto& [a] = t; f(a); }
+        else if constexpr(n == 2){ auto& [a, b] = t; f(a); f(b); }
+        else if constexpr(n == 3){ auto& [a, b, c] = t; f(a); f(b); f(c); }
+        else { auto& [a, b, c, d] = t; f(a); f(b); f(c); f(d); }
+    }
+}
+
+template<typename DataStream, typename T, detail::reflected_aggregate<T> = 0>
+DataStream& operator << (DataStream& ds, const T& t){
+    detail::for_each_field(t, [&](const auto& f){ ds << f; });
+    return ds;
+}
+
+template<typename DataStream, typename T, detail::reflected_aggregate<T> = 0>
+DataStream& operator >> (DataStream& ds, T& t){
+    detail::for_each_field(t, [&](auto& f){ ds >> f; });
+    return ds;
+}
+
+template<typename T>
+size_t pack_size(const T& value){
+    datastream<size_t> ps;
+    ps << value;
+    return ps.tellp();
+}
+
+template<typename T>
+std::vector<char> pack(const T& value){
+    std::vector<char> result(pack_size(value));
+    datastream<char*> ds(result.data(), result.size());
+    ds << value;
+    return result;
+}
+
+template<typename T>
+T unpack(const char* buffer, size_t len){
+    T result;
+    datastream<char*> ds(const_cast<char*>(buffer), len);
+    ds >> result;
+    return result;
+}
+
+template<typename T>
+T unpack(const std::vector<char>& bytes){
+    return unpack<T>(bytes.data(), bytes.size());
+}
+
+}
+
+#define EOSLIB_REFLECT_MEMBER_OP( r, OP, elem ) \
+    OP t.elem
+
+#define EOSLIB_SERIALIZE( TYPE, MEMBERS ) \
+    static constexpr bool eosio_serialized = true; \
+    template<typename DataStream> \
+    friend DataStream& operator << ( DataStream& ds, const TYPE& t ){ \
+        return ds BOOST_PP_SEQ_FOR_EACH( EOSLIB_REFLECT_MEMBER_OP, <<, MEMBERS ); \
+    } \
+    template<typename DataStream> \
+    friend DataStream& operator >> ( DataStream& ds, TYPE& t ){ \
+        return ds BOOST_PP_SEQ_FOR_EACH( EOSLIB_REFLECT_MEMBER_OP, >>, MEMBERS ); \
+    }
+
+namespace eosio {
+
+template<typename DataStream>
+DataStream& operator << (DataStream& ds, const checksum256& c){
+    ds.write((const char*)c.hash, sizeof(c.hash));
+    return ds;
+}
+
+template<typename DataStream>
+DataStream& operator >> (DataStream& ds, checksum256& c){
+    ds.read((char*)c.hash, sizeof(c.hash));
+    return ds;
+}
+
+}
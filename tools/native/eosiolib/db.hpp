@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "system.hpp"
+
+//按主键有序的表存储接口，由tools/native/chain.cpp实现
+namespace eosio { namespace native {
+
+bool db_get(uint64_t code, uint64_t scope, uint64_t table, uint64_t id, std::vector<char>& data);
+bool db_lowerbound(uint64_t code, uint64_t scope, uint64_t table, uint64_t id, uint64_t& found, std::vector<char>& data);
+void db_store(uint64_t code, uint64_t scope, uint64_t table, account_name payer, uint64_t id, const std::vector<char>& data);
+void db_update(uint64_t code, uint64_t scope, uint64_t table, account_name payer, uint64_t id, const std::vector<char>& data);
+void db_remove(uint64_t code, uint64_t scope, uint64_t table, uint64_t id);
+
+} }
@@ -0,0 +1,72 @@
+#pragma once
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <boost/preprocessor/seq/for_each.hpp>
+#include <boost/preprocessor/stringize.hpp>
+#include "system.hpp"
+#include "name.hpp"
+#include "datastream.hpp"
+#include "symbol.hpp"
+#include "multi_index.hpp"
+
+namespace eosio {
+
+using ::eosio_assert;
+
+struct permission_level {
+    permission_level(account_name a, permission_name p):actor(a), permission(p){}
+    permission_level():actor(0), permission(0){}
+
+    account_name    actor;
+    permission_name permission;
+};
+
+namespace native {
+    void send_inline(account_name account, action_name name, const std::vector<permission_level>& authorization, const std::vector<char>& data);
+    const std::vector<char>& current_action_data();
+}
+
+struct action {
+    account_name                  account;
+    action_name                   name;
+    std::vector<permission_level> authorization;
+    std::vector<char>             data;
+
+    template<typename T>
+    action(const permission_level& auth, account_name a, action_name n, T&& value)
+    :account(a), name(n), authorization(1, auth), data(pack(std::forward<T>(value))){}
+
+    void send()const { native::send_inline(account, name, authorization, data); }
+};
+
+template<typename T>
+T unpack_action_data(){
+    return unpack<T>(native::current_action_data());
+}
+
+class contract {
+  public:
+    contract(account_name n):_self(n){}
+    account_name get_self()const { return _self; }
+
+  protected:
+    account_name _self;
+};
+
+template<typename T, typename Q, typename... Args>
+bool execute_action(T* obj, void (Q::*func)(Args...)){
+    auto args = unpack_action_data<std::tuple<std::decay_t<Args>...>>();
+    std::apply([&](auto&... a){ (obj->*func)(a...); }, args);
+    return true;
+}
+
+}
+
+#define EOSIO_API_CALL( r, OP, elem ) \
+    case ::string_to_name( BOOST_PP_STRINGIZE(elem) ): \
+        eosio::execute_action( &thiscontract, &OP::elem ); \
+        break;
+
+#define EOSIO_API( TYPE, MEMBERS ) \
+    BOOST_PP_SEQ_FOR_EACH( EOSIO_API_CALL, TYPE, MEMBERS )
@@ -0,0 +1,128 @@
+#pragma once
+#include <map>
+#include <vector>
+#include "datastream.hpp"
+#include "db.hpp"
+
+namespace eosio {
+
+//只支持主键索引，行对象按主键缓存在实例中（std::map节点地址不变），与wasm版multi_index一样在同一实例内保持引用稳定
+template<uint64_t TableName, typename T>
+class multi_index {
+  public:
+    class const_iterator {
+      public:
+        const_iterator():_idx(nullptr), _item(nullptr){}
+        const_iterator(const multi_index* idx, const T* item):_idx(idx), _item(item){}
+
+        const T& operator*()const { return *_item; }
+        const T* operator->()const { return _item; }
+
+        const_iterator& operator++(){
+            eosio_assert(_item != nullptr, "cannot increment end iterator");
+            uint64_t pk = _item->primary_key();
+            _item = pk == uint64_t(-1) ? nullptr : _idx->load_lowerbound(pk + 1);
+            return *this;
+        }
+        const_iterator operator++(int){
+            auto tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator == (const const_iterator& o)const { return _item == o._item; }
+        bool operator != (const const_iterator& o)const { return _item != o._item; }
+
+      private:
+        friend class multi_index;
+        const multi_index* _idx;
+        const T* _item;
+    };
+
+    multi_index(uint64_t code, uint64_t scope):_code(code), _scope(scope){}
+
+    uint64_t get_code()const { return _code; }
+    uint64_t get_scope()const { return _scope; }
+
+    const_iterator begin()const { return const_iterator(this, load_lowerbound(0)); }
+    const_iterator end()const { return const_iterator(this, nullptr); }
+    const_iterator lower_bound(uint64_t pk)const { return const_iterator(this, load_lowerbound(pk)); }
+
+    const_iterator find(uint64_t pk)const {
+        auto itr = _items.find(pk);
+        if(itr != _items.end())
+            return const_iterator(this, &itr->second);
+        std::vector<char> data;
+        if(!native::db_get(_code, _scope, TableName, pk, data))
+            return end();
+        return const_iterator(this, cache(pk, data));
+    }
+
+    const T& get(uint64_t pk, const char* error_msg = "unable to find key")const {
+        auto itr = find(pk);
+        eosio_assert(itr != end(), error_msg);
+        return *itr;
+    }
+
+    template<typename Lambda>
+    const_iterator emplace(account_name payer, Lambda&& constructor){
+        T obj;
+        constructor(obj);
+        uint64_t pk = obj.primary_key();
+        eosio_assert(find(pk) == end(), "could not insert object, most likely a uniqueness constraint was violated");
+        native::db_store(_code, _scope, TableName, payer, pk, pack(obj));
+        auto itr = _items.emplace(pk, std::move(obj)).first;
+        return const_iterator(this, &itr->second);
+    }
+
+    template<typename Lambda>
+    void modify(const_iterator itr, account_name payer, Lambda&& updater){
+        eosio_assert(itr != end(), "cannot pass end iterator to modify");
+        modify(*itr, payer, std::forward<Lambda>(updater));
+    }
+
+    template<typename Lambda>
+    void modify(const T& obj, account_name payer, Lambda&& updater){
+        auto& mutable_obj = const_cast<T&>(obj);
+        uint64_t pk = obj.primary_key();
+        updater(mutable_obj);
+        eosio_assert(pk == uint64_t(obj.primary_key()), "updater cannot change primary key when modifying an object");
+        native::db_update(_code, _scope, TableName, payer, pk, pack(obj));
+    }
+
+    const_iterator erase(const_iterator itr){
+        eosio_assert(itr != end(), "cannot pass end iterator to erase");
+        auto next = itr;
+        ++next;
+        erase(*itr);
+        return next;
+    }
+
+    void erase(const T& obj){
+        uint64_t pk = obj.primary_key();
+        native::db_remove(_code, _scope, TableName, pk);
+        _items.erase(pk);
+    }
+
+  private:
+    const T* cache(uint64_t pk, const std::vector<char>& data)const {
+        auto itr = _items.find(pk);
+        if(itr == _items.end())
+            itr = _items.emplace(pk, unpack<T>(data)).first;
+        return &itr->second;
+    }
+
+    const T* load_lowerbound(uint64_t pk)const {
+        uint64_t found = 0;
+        std::vector<char> data;
+        if(!native::db_lowerbound(_code, _scope, TableName, pk, found, data))
+            return nullptr;
+        return cache(found, data);
+    }
+
+    uint64_t _code;
+    uint64_t _scope;
+    mutable std::map<uint64_t, T> _items;
+};
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "system.hpp"
+
+static constexpr char char_to_symbol(char c){
+    if(c >= 'a' && c <= 'z')
+        return (c - 'a') + 6;
+    if(c >= '1' && c <= '5')
+        return (c - '1') + 1;
+    return 0;
+}
+
+static constexpr uint64_t string_to_name(const char* str){
+    uint64_t name = 0;
+    int i = 0;
+    for(; str[i] && i < 12; ++i){
+        name |= (uint64_t(char_to_symbol(str[i])) & 0x1f) << (64 - 5 * (i + 1));
+    }
+    if(i == 12)
+        name |= uint64_t(char_to_symbol(str[12])) & 0x0F;
+    return name;
+}
+
+#define N(X) ::string_to_name(#X)
+
+inline std::string name_to_string(uint64_t value){
+    static const char* charmap = ".12345abcdefghijklmnopqrstuvwxyz";
+    std::string str(13, '.');
+    uint64_t tmp = value;
+    for(uint32_t i = 0; i <= 12; ++i){
+        char c = charmap[tmp & (i == 0 ? 0x0f : 0x1f)];
+        str[12 - i] = c;
+        tmp >>= (i == 0 ? 4 : 5);
+    }
+    str.erase(str.find_last_not_of('.') + 1);
+    return str;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include "datastream.hpp"
+
+namespace eosio {
+
+static constexpr uint64_t string_to_symbol(uint8_t precision, const char* str){
+    uint64_t result = 0;
+    for(uint32_t i = 0; str[i]; ++i){
+        result |= (uint64_t(str[i]) << (8 * (1 + i)));
+    }
+    return result | uint64_t(precision);
+}
+
+#define S(P,X) ::eosio::string_to_symbol(P,#X)
+
+struct symbol_type {
+    symbol_name value;
+
+    constexpr symbol_type(symbol_name v = S(4,SYS)):value(v){}
+    constexpr operator symbol_name()const { return value; }
+    bool is_valid()const { return true; }
+    uint64_t precision()const { return value & 0xff; }
+    symbol_name name()const { return value >> 8; }
+
+    EOSLIB_SERIALIZE(symbol_type, (value))
+};
+
+struct asset {
+    int64_t     amount;
+    symbol_type symbol;
+
+    static constexpr int64_t max_amount = (1LL << 62) - 1;
+
+    explicit asset(int64_t a = 0, symbol_type s = S(4,SYS)):amount(a), symbol(s){}
+
+    bool is_amount_within_range()const { return -max_amount <= amount && amount <= max_amount; }
+    bool is_valid()const { return is_amount_within_range() && symbol.is_valid(); }
+
+    asset operator-()const { return asset(-amount, symbol); }
+
+    asset& operator -= (const asset& a){
+        eosio_assert(a.symbol == symbol, "attempt to subtract asset with different symbol");
+        amount -= a.amount;
+        eosio_assert(-max_amount <= amount, "subtraction underflow");
+        eosio_assert(amount <= max_amount, "subtraction overflow");
+        return *this;
+    }
+
+    asset& operator += (const asset& a){
+        eosio_assert(a.symbol == symbol, "attempt to add asset with different symbol");
+        amount += a.amount;
+        eosio_assert(-max_amount <= amount, "addition underflow");
+        eosio_assert(amount <= max_amount, "addition overflow");
+        return *this;
+    }
+
+    friend asset operator + (const asset& a, const asset& b){
+        asset result = a;
+        result += b;
+        return result;
+    }
+
+    friend asset operator - (const asset& a, const asset& b){
+        asset result = a;
+        result -= b;
+        return result;
+    }
+
+    friend bool operator == (const asset& a, const asset& b){
+        eosio_assert(a.symbol == b.symbol, "comparison of assets with different symbols is not allowed");
+        return a.amount == b.amount;
+    }
+
+    friend bool operator != (const asset& a, const asset& b){ return !(a == b); }
+
+    friend bool operator < (const asset& a, const asset& b){
+        eosio_assert(a.symbol == b.symbol, "comparison of assets with different symbols is not allowed");
+        return a.amount < b.amount;
+    }
+
+    EOSLIB_SERIALIZE(asset, (amount)(symbol))
+};
+
+}
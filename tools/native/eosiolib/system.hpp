@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+//原生编译用的eosiolib替代实现，接口与合约使用到的wasm版eosiolib一致，由tools/native/chain.cpp提供运行时
+#define EOSIO_NATIVE 1
+
+typedef uint64_t account_name;
+typedef uint64_t permission_name;
+typedef uint64_t table_name;
+typedef uint64_t scope_name;
+typedef uint64_t action_name;
+typedef uint64_t symbol_name;
+typedef uint32_t time;
+
+struct checksum256 {
+    uint8_t hash[32];
+};
+
+struct eosio_assert_exception : std::runtime_error {
+    explicit eosio_assert_exception(const char* msg):std::runtime_error(msg){}
+};
+
+inline void eosio_assert(uint32_t test, const char* msg){
+    if(!test)
+        throw eosio_assert_exception(msg);
+}
+
+uint32_t now();
+void require_auth(account_name name);
+bool has_auth(account_name name);
+void require_recipient(account_name name);
+bool is_account(account_name name);
+void prints(const char* cstr);
+void sha256(const char* data, uint32_t length, checksum256* hash);
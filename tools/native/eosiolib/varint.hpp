@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+
+namespace eosio {
+
+struct unsigned_int {
+    uint32_t value;
+    unsigned_int(uint32_t v = 0):value(v){}
+    operator uint32_t()const { return value; }
+};
+
+}
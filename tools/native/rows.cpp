@@ -0,0 +1,101 @@
+#include "rows.hpp"
+#include <map>
+#include <vector>
+#include "chain.hpp"
+#define MEDISHARES_NO_APPLY
+#include "../../medishares.hpp"
+
+//medishares的表结构为私有成员，本结构体是合约中声明的友元
+struct medishares_rows {
+    typedef struct medishares::global     global;
+    typedef struct medishares::keymarket  keymarket;
+    typedef struct medishares::merkletree merkletree;
+    typedef struct medishares::merklenode merklenode;
+
+    template<typename Row>
+    static std::vector<Row> rows(uint64_t self, uint64_t table){
+        std::vector<Row> result;
+        native_chain::for_each_row(self, self, table, [](uint64_t, const std::vector<char>& data, void* ctx){
+            static_cast<std::vector<Row>*>(ctx)->push_back(eosio::unpack<Row>(data));
+        }, &result);
+        return result;
+    }
+};
+
+namespace native_rows {
+
+bool read_global(uint64_t self, global_row& out){
+    auto rows = medishares_rows::rows<medishares_rows::global>(self, N(global2));
+    if(rows.empty()) return false;
+    const auto& g = rows.front();
+    out.ref_rate = g.ref_rate;
+    out.guarantee_rate = g.guarantee_rate;
+    out.guarantee_pool = g.guarantee_pool.amount;
+    out.bonus_pool = g.bonus_pool.amount;
+    out.cases_num = g.cases_num;
+    out.applied_cases = g.applied_cases;
+    out.guaranteed_accounts = g.guaranteed_accounts;
+    out.total_key = g.total_key.amount;
+    out.total_skey = g.total_skey.amount;
+    out.total_donate = g.total_donate.amount;
+    memcpy(out.merkle_root, g.merkle_root.hash, sizeof(out.merkle_root));
+    return true;
+}
+
+bool read_keymarket(uint64_t self, keymarket_row& out){
+    auto rows = medishares_rows::rows<medishares_rows::keymarket>(self, N(keymarket2));
+    if(rows.empty()) return false;
+    const auto& k = rows.front();
+    out.supply = k.supply.amount;
+    out.base_balance = k.base.balance.amount;
+    out.quote_balance = k.quote.balance.amount;
+    return true;
+}
+
+static bool same(const checksum256& a, const checksum256& b){
+    return memcmp(a.hash, b.hash, sizeof(a.hash)) == 0;
+}
+
+bool check_merkle(uint64_t self, std::string& error){
+    std::map<uint64_t, std::map<uint64_t, checksum256>> leaves;
+    for(const auto& n : medishares_rows::rows<medishares_rows::merklenode>(self, N(merklenode))){
+        if(merkle_is_zero(n.hash)){
+            error = "merklenode " + std::to_string(n.id) + " stores a zero hash";
+            return false;
+        }
+        if(((n.id >> 56) & 0x3f) == 0) leaves[n.id >> 62][n.id & ((1ull << 56) - 1)] = n.hash;
+    }
+
+    checksum256 roots[2] = {merkle_zero(), merkle_zero()};
+    for(const auto& t : medishares_rows::rows<medishares_rows::merkletree>(self, N(merkletree))){
+        //按merkle.hpp的规则逐层归约，空子树为全0哈希
+        auto level = leaves[t.tree];
+        for(uint64_t depth = 0; depth < t.depth; depth ++){
+            std::map<uint64_t, checksum256> parents;
+            for(const auto& node : level){
+                uint64_t index = node.first;
+                if(parents.count(index >> 1)) continue;
+                auto left = level.find(index & ~1ull);
+                auto right = level.find(index | 1);
+                parents[index >> 1] = merkle_parent(left == level.end() ? merkle_zero() : left->second,
+                                                    right == level.end() ? merkle_zero() : right->second);
+            }
+            level.swap(parents);
+        }
+        checksum256 root = level.count(0) ? level[0] : merkle_zero();
+        if(!same(root, t.root)){
+            error = "tree " + std::to_string(t.tree) + " root does not match its leaves";
+            return false;
+        }
+        if(t.tree < 2) roots[t.tree] = root;
+    }
+
+    auto globals = medishares_rows::rows<medishares_rows::global>(self, N(global2));
+    if(!globals.empty() && !same(globals.front().merkle_root, merkle_parent(roots[MERKLE_BALANCE_TREE], roots[MERKLE_CONTRIB_TREE]))){
+        error = "global.merkle_root does not match the tree roots";
+        return false;
+    }
+    return true;
+}
+
+}
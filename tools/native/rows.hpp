@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+//按medishares.hpp中的表结构解码原生运行环境中的表行，返回不依赖eosiolib的普通结构。
+//工具主程序只需包含本头文件并链接rows.cpp，表结构变化时不必同步修改各工具中的字节偏移。
+namespace native_rows {
+
+struct global_row {
+    uint64_t ref_rate;
+    uint64_t guarantee_rate;
+    int64_t  guarantee_pool;
+    int64_t  bonus_pool;
+    uint64_t cases_num;
+    uint64_t applied_cases;
+    uint64_t guaranteed_accounts;
+    int64_t  total_key;
+    int64_t  total_skey;
+    int64_t  total_donate;
+    uint8_t  merkle_root[32];
+};
+
+struct keymarket_row {
+    int64_t supply;
+    int64_t base_balance;   //KEY
+    int64_t quote_balance;  //EMDS
+};
+
+//receiver合约的global2、keymarket2表，表不存在时返回false
+bool read_global(uint64_t self, global_row& out);
+bool read_keymarket(uint64_t self, keymarket_row& out);
+
+//由merklenode中的叶子重新计算两棵Merkle树，与merkletree中的树根及global.merkle_root比对，并检查merklenode只存储非0节点；
+//不一致时返回false，error给出第一处不一致
+bool check_merkle(uint64_t self, std::string& error);
+
+}